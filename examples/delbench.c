@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ *	Simple AVL tree - multi-threaded deletion benchmark
+ *
+ *	Each thread builds its own tree (with keys added in random order) and
+ *	then deletes every node from it, in a different random order, with
+ *	savl_remove_node().  The threads share no tree (and the library has no
+ *	global state), so aggregate deletion throughput should scale with the
+ *	number of threads, up to the number of CPUs.
+ *
+ *	Usage: delbench [MAX_THREADS [NODES_PER_THREAD]]
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <savl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_NODES	1000000
+#define ROUNDS		3
+
+struct record {
+	uint64_t		key;
+	struct savl_node	node;
+};
+
+struct worker {
+	pthread_t		thread;
+	struct record		*records;
+	size_t			count;
+	unsigned int		seed;
+};
+
+#define RECORD_FROM_NODE(n)	SAVL_NODE_CONTAINER((n), struct record, node)
+
+static pthread_barrier_t start_barrier;
+static pthread_barrier_t done_barrier;
+
+static int cmp_keys(const union savl_key k, const struct savl_node *const n)
+{
+	const uint64_t node_key = RECORD_FROM_NODE(n)->key;
+
+	return (k.u > node_key) - (k.u < node_key);
+}
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void *worker_main(void *const arg)
+{
+	struct worker *const w = arg;
+	struct savl_node *tree = NULL;
+	union savl_key key;
+	uint64_t tmp;
+	size_t i, j;
+
+	for (i = 0; i < w->count; ++i)
+		w->records[i].key = i;
+
+	for (i = w->count - 1; i > 0; --i) {
+		j = (size_t)rand_r(&w->seed) % (i + 1);
+		tmp = w->records[i].key;
+		w->records[i].key = w->records[j].key;
+		w->records[j].key = tmp;
+	}
+
+	for (i = 0; i < w->count; ++i) {
+		key.u = w->records[i].key;
+		savl_add(&tree, cmp_keys, key, &w->records[i].node, 0);
+	}
+
+	pthread_barrier_wait(&start_barrier);
+
+	/* Records are in random key order */
+	for (i = 0; i < w->count; ++i)
+		savl_remove_node(&w->records[i].node, &tree);
+
+	pthread_barrier_wait(&done_barrier);
+
+	if (tree != NULL) {
+		fputs("Tree is not empty!\n", stderr);
+		exit(EXIT_FAILURE);
+	}
+
+	return NULL;
+}
+
+static double run(struct worker *const workers, const unsigned int threads)
+{
+	double start, elapsed, best;
+	unsigned int i, r;
+
+	best = 0;
+
+	for (r = 0; r < ROUNDS; ++r) {
+
+		pthread_barrier_init(&start_barrier, NULL, threads + 1);
+		pthread_barrier_init(&done_barrier, NULL, threads + 1);
+
+		for (i = 0; i < threads; ++i) {
+			workers[i].seed = i + 1;
+			pthread_create(&workers[i].thread, NULL, worker_main,
+				       &workers[i]);
+		}
+
+		pthread_barrier_wait(&start_barrier);
+		start = now_ms();
+		pthread_barrier_wait(&done_barrier);
+		elapsed = now_ms() - start;
+
+		for (i = 0; i < threads; ++i)
+			pthread_join(workers[i].thread, NULL);
+
+		pthread_barrier_destroy(&done_barrier);
+		pthread_barrier_destroy(&start_barrier);
+
+		if (r == 0 || elapsed < best)
+			best = elapsed;
+	}
+
+	return best;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int max_threads, threads, i;
+	double elapsed, rate, base_rate;
+	struct worker *workers;
+	size_t count;
+	long cpus;
+
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	max_threads = argc > 1 ? strtoul(argv[1], NULL, 0)
+			       : (cpus > 0 ? (unsigned int)cpus : 1);
+	count = argc > 2 ? strtoul(argv[2], NULL, 0) : DEFAULT_NODES;
+
+	if (max_threads == 0 || count == 0) {
+		fprintf(stderr, "Usage: %s [MAX_THREADS [NODES_PER_THREAD]]\n",
+			argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	workers = calloc(max_threads, sizeof *workers);
+	if (workers == NULL) {
+		perror("calloc");
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < max_threads; ++i) {
+		workers[i].count = count;
+		workers[i].records = malloc(count * sizeof *workers[i].records);
+		if (workers[i].records == NULL) {
+			perror("malloc");
+			return EXIT_FAILURE;
+		}
+	}
+
+	printf("%zu nodes per thread, %ld CPUs, best of %d runs\n",
+	       count, cpus, ROUNDS);
+	printf("%8s %12s %16s %8s\n", "threads", "time (ms)", "deletions/s",
+	       "speedup");
+
+	base_rate = 0;
+
+	for (threads = 1; ; threads *= 2) {
+
+		if (threads > max_threads)
+			threads = max_threads;
+
+		elapsed = run(workers, threads);
+		rate = (double)count * threads / (elapsed / 1000.0);
+		if (threads == 1)
+			base_rate = rate;
+
+		printf("%8u %12.1f %16.0f %8.2f\n",
+		       threads, elapsed, rate, rate / base_rate);
+
+		if (threads == max_threads)
+			break;
+	}
+
+	for (i = 0; i < max_threads; ++i)
+		free(workers[i].records);
+	free(workers);
+
+	return EXIT_SUCCESS;
+}
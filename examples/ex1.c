@@ -6,7 +6,6 @@
  *	Copyright 2022 Ian Pilcher <arequipeno@gmail.com>
  */
 
-#include <assert.h>
 #include <inttypes.h>
 #include <savl.h>
 #include <stdio.h>
@@ -73,35 +72,36 @@ static void free_by_name(struct savl_node *const n)
 
 static _Bool add_employee(struct employee *emp)
 {
-	struct savl_node *existing;
-	union savl_key key;
+	struct savl_multi_entry entries[2] = {
+		{
+			.tree	= &employees_by_number,
+			.cmpfn	= cmp_numbers,
+			.key	= { .u = emp->employee_number },
+			.node	= &emp->number_node
+		},
+		{
+			.tree	= &employees_by_name,
+			.cmpfn	= cmp_names,
+			.key	= { .p = emp },
+			.node	= &emp->name_node
+		}
+	};
+	size_t conflict;
+
+	/* Add to both trees, unless either already contains the employee */
+	if (savl_multi_add(entries, 2, &conflict) == NULL)
+		return 1;
 
-	/* Check for an existing employee with the same number */
-	key.u = emp->employee_number;
-	existing = savl_get(employees_by_number, cmp_numbers, key);
-	if (existing != NULL) {
+	if (conflict == 0) {
 		fprintf(stderr, "Employee #%" PRIu32 " already exists!\n",
 			emp->employee_number);
-		return 0;
 	}
-
-	/* Try to add the employee to the by-name tree */
-	key.p = emp;
-	existing = savl_try_add(&employees_by_name, cmp_names, key,
-				&emp->name_node);
-	if (existing != NULL) {
+	else {
 		fprintf(stderr, "Employee %s, %s already exists!\n",
 			emp->family_name, emp->given_name);
-		return 0;
 	}
 
-	/* Actually add the employee to the by-number tree */
-	key.u = emp->employee_number;
-	existing = savl_try_add(&employees_by_number, cmp_numbers, key,
-				&emp->number_node);
-	assert(existing == NULL);
-
-	return 1;
+	return 0;
 }
 
 static struct employee *get_by_name(char *restrict const family_name,
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ *	Simple AVL tree - full traversal benchmark
+ *
+ *	Compares a full in-order scan that uses savl_next() with the same scan
+ *	through a stack-based iterator (savl_iter_next() and savl_iter_next_n()).
+ *
+ *	Usage: iterbench [NODES]
+ */
+
+#include <inttypes.h>
+#include <savl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_NODES	2000000
+#define ROUNDS		5
+#define BATCH		64
+
+struct record {
+	uint64_t		key;
+	struct savl_node	node;
+};
+
+#define RECORD_FROM_NODE(n)	SAVL_NODE_CONTAINER((n), struct record, node)
+
+static int cmp_keys(const union savl_key k, const struct savl_node *const n)
+{
+	const uint64_t node_key = RECORD_FROM_NODE(n)->key;
+
+	return (k.u > node_key) - (k.u < node_key);
+}
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static uint64_t scan_next(struct savl_node *const tree)
+{
+	struct savl_node *node;
+	uint64_t sum = 0;
+
+	for (node = savl_first(tree); node != NULL; node = savl_next(node))
+		sum += RECORD_FROM_NODE(node)->key;
+
+	return sum;
+}
+
+static uint64_t scan_iter(struct savl_node *const tree)
+{
+	struct savl_node *node;
+	struct savl_iter it;
+	uint64_t sum = 0;
+
+	for (node = savl_iter_first(&it, tree); node != NULL;
+						node = savl_iter_next(&it)) {
+		sum += RECORD_FROM_NODE(node)->key;
+	}
+
+	return sum;
+}
+
+static uint64_t scan_batch(struct savl_node *const tree)
+{
+	struct savl_node *batch[BATCH];
+	struct savl_iter it;
+	uint64_t sum = 0;
+	size_t i, n;
+
+	savl_iter_first(&it, tree);
+
+	while ((n = savl_iter_next_n(&it, batch, BATCH)) > 0) {
+		for (i = 0; i < n; ++i)
+			sum += RECORD_FROM_NODE(batch[i])->key;
+	}
+
+	return sum;
+}
+
+static void run(const char *const name,
+		uint64_t (*const scan)(struct savl_node *),
+		struct savl_node *const tree, const uint64_t expected)
+{
+	double start, elapsed, best;
+	unsigned int i;
+
+	best = 0;
+
+	for (i = 0; i < ROUNDS; ++i) {
+
+		start = now_ms();
+		if (scan(tree) != expected) {
+			fprintf(stderr, "%s: wrong result\n", name);
+			exit(EXIT_FAILURE);
+		}
+		elapsed = now_ms() - start;
+
+		if (i == 0 || elapsed < best)
+			best = elapsed;
+	}
+
+	printf("%-24s %10.1f ms\n", name, best);
+}
+
+int main(int argc, char *argv[])
+{
+	struct savl_node *tree = NULL;
+	struct record *records;
+	uint64_t expected, tmp;
+	size_t count, i, j;
+	union savl_key key;
+
+	count = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_NODES;
+	if (count == 0) {
+		fprintf(stderr, "Usage: %s [NODES]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	records = malloc(count * sizeof *records);
+	if (records == NULL) {
+		perror("malloc");
+		return EXIT_FAILURE;
+	}
+
+	/* Shuffled keys, so that tree order is unrelated to memory order */
+	for (i = 0; i < count; ++i)
+		records[i].key = i;
+
+	srand(1);
+
+	for (i = count - 1; i > 0; --i) {
+		j = (size_t)rand() % (i + 1);
+		tmp = records[i].key;
+		records[i].key = records[j].key;
+		records[j].key = tmp;
+	}
+
+	for (i = 0; i < count; ++i) {
+		key.u = records[i].key;
+		savl_add(&tree, cmp_keys, key, &records[i].node, 0);
+	}
+
+	expected = (uint64_t)count * (count - 1) / 2;
+
+	printf("%zu nodes, best of %d scans\n", count, ROUNDS);
+	run("savl_next()", scan_next, tree, expected);
+	run("savl_iter_next()", scan_iter, tree, expected);
+	run("savl_iter_next_n()", scan_batch, tree, expected);
+
+	free(records);
+
+	return EXIT_SUCCESS;
+}
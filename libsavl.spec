@@ -27,7 +27,7 @@ API documentation for libsavl, in HTML format.
 
 %build
 # Build the library
-gcc %optflags -std=gnu99 -Wall -Wextra -Wcast-align -shared -fPIC \
+gcc %optflags -std=gnu99 -Wall -Wextra -Wcast-align -shared -fPIC -pthread \
 	-Wl,-soname,%{name}.so.%{so_ver} -o %{name}.so.%{version} savl.c
 # Build the API docs
 doxygen Doxyfile
@@ -9,6 +9,13 @@
 #include "savl.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #define SAVL_DBL_LEFT	((int_fast8_t)	-2)
 #define SAVL_LEFT	((int_fast8_t)	-1)
@@ -16,6 +23,75 @@
 #define SAVL_RIGHT	((int_fast8_t)	 1)
 #define SAVL_DBL_RIGHT	((int_fast8_t)	 2)
 
+/*
+ * Node parent and skew accessors.  With SAVL_COMPACT_NODE, the skew (offset
+ * by 2, so that it is never negative) is stored in the low-order 3 bits of the
+ * parent pointer, which are always zero because nodes are 8-byte aligned.
+ */
+
+#ifdef SAVL_COMPACT_NODE
+
+#define SAVL_SKEW_MASK		((uintptr_t)7)
+
+static inline struct savl_node *savl_parent(const struct savl_node *const node)
+{
+	return (struct savl_node *)(node->parent_skew & ~SAVL_SKEW_MASK);
+}
+
+static inline void savl_set_parent(struct savl_node *const node,
+				   struct savl_node *const parent)
+{
+	node->parent_skew =
+		(uintptr_t)parent | (node->parent_skew & SAVL_SKEW_MASK);
+}
+
+static inline int_fast8_t savl_skew(const struct savl_node *const node)
+{
+	return (int_fast8_t)(node->parent_skew & SAVL_SKEW_MASK) - 2;
+}
+
+static inline void savl_set_skew(struct savl_node *const node,
+				 const int_fast8_t skew)
+{
+	node->parent_skew =
+		(node->parent_skew & ~SAVL_SKEW_MASK) | (uintptr_t)(skew + 2);
+}
+
+#else
+
+static inline struct savl_node *savl_parent(const struct savl_node *const node)
+{
+	return node->parent;
+}
+
+static inline void savl_set_parent(struct savl_node *const node,
+				   struct savl_node *const parent)
+{
+	node->parent = parent;
+}
+
+static inline int_fast8_t savl_skew(const struct savl_node *const node)
+{
+	return node->skew;
+}
+
+static inline void savl_set_skew(struct savl_node *const node,
+				 const int_fast8_t skew)
+{
+	node->skew = skew;
+}
+
+#endif
+
+/* Number of searches that savl_get_batch() runs in lockstep */
+#define SAVL_BATCH_GROUP	16
+
+#ifdef __GNUC__
+#define SAVL_PREFETCH(addr)	__builtin_prefetch(addr)
+#else
+#define SAVL_PREFETCH(addr)	((void)(addr))
+#endif
+
 /**
  * Determine whether a node is the left or right child of its parent.
  *
@@ -28,13 +104,13 @@
  */
 static int_fast8_t savl_which_child(const struct savl_node *const node)
 {
-	if (node->parent == NULL)
+	if (savl_parent(node) == NULL)
 		return SAVL_EVEN;
 
-	if (node->parent->left == node)
+	if (savl_parent(node)->left == node)
 		return SAVL_LEFT;
 
-	assert(node->parent->right == node);
+	assert(savl_parent(node)->right == node);
 	return SAVL_RIGHT;
 }
 
@@ -57,7 +133,7 @@ static int_fast8_t savl_rdepth_of_left(const struct savl_node *const node,
 	 * So depth(node) = depth(left subtree) + 1, so
 	 * depth(left subtree) = depth(node) - 1.
 	 */
-	if (node->skew <= SAVL_EVEN)
+	if (savl_skew(node) <= SAVL_EVEN)
 		return node_rdepth - 1;
 
 	/*
@@ -71,7 +147,7 @@ static int_fast8_t savl_rdepth_of_left(const struct savl_node *const node,
 	 * depth(left subtree) = depth(right subtree) - skew, and
 	 * depth(left subtree) = (depth(node) - 1) - skew.
 	 */
-	return node_rdepth - 1 - node->skew;
+	return node_rdepth - 1 - savl_skew(node);
 }
 
 /**
@@ -93,7 +169,7 @@ static int_fast8_t savl_rdepth_of_right(const struct savl_node *const node,
 	 * So depth(node) = depth(right subtree) + 1, so
 	 * depth(right subtree) = depth(node) - 1.
 	 */
-	if (node->skew >= SAVL_EVEN)
+	if (savl_skew(node) >= SAVL_EVEN)
 		return node_rdepth - 1;
 
 	/*
@@ -107,7 +183,7 @@ static int_fast8_t savl_rdepth_of_right(const struct savl_node *const node,
 	 * depth(right subtree) = depth(left subtree) + skew, and
 	 * depth(right subtree) = (depth(node) - 1) + skew.
 	 */
-	return node_rdepth - 1 + node->skew;
+	return node_rdepth - 1 + savl_skew(node);
 }
 
 /**
@@ -126,7 +202,7 @@ static int_fast8_t savl_rdepth_from_right(const struct savl_node *const node,
 	 * If node is even or skewed right (including double-right), the depth
 	 * of its subtree is determined by the depth of its right child subtree.
 	 */
-	if (node->skew >= SAVL_EVEN)
+	if (savl_skew(node) >= SAVL_EVEN)
 		return right_rdepth + 1;
 
 	/*
@@ -137,7 +213,7 @@ static int_fast8_t savl_rdepth_from_right(const struct savl_node *const node,
 	 * skew + depth(left subtree) = depth(right subtree), and
 	 * depth(left subtree) = depth(right subtree) - skew.
 	 */
-	return right_rdepth - node->skew + 1;
+	return right_rdepth - savl_skew(node) + 1;
 }
 
 /**
@@ -156,7 +232,7 @@ static int_fast8_t savl_rdepth_from_left(const struct savl_node *const node,
 	 * If node is even or skewed left (including double-left), the depth of
 	 * its subtree is determined by the depth of its left child subtree.
 	 */
-	if (node->skew <= SAVL_EVEN)
+	if (savl_skew(node) <= SAVL_EVEN)
 		return left_rdepth + 1;
 
 	/*
@@ -167,7 +243,7 @@ static int_fast8_t savl_rdepth_from_left(const struct savl_node *const node,
 	 * skew + depth(left subtree) = depth(right subtree), and
 	 * depth(right subtree) = depth(left subtree) + skew.
 	 */
-	return left_rdepth + node->skew + 1;
+	return left_rdepth + savl_skew(node) + 1;
 }
 
 /**
@@ -199,10 +275,12 @@ static int_fast8_t savl_rdepth_from_left(const struct savl_node *const node,
  *
  * @param[in,out] subtree	Double pointer to the root of the subtree.
  *				<b>`*subtree`</b> is set to the new root.
+ * @param aug			Augmentation callback (or <b>`NULL`</b>).
  *
  * @return	The change (if any) to the depth of the subtree.
  */
-static int_fast8_t savl_promote_left(struct savl_node **const subtree)
+static int_fast8_t savl_promote_left(struct savl_node **const subtree,
+				     const struct savl_aug *const aug)
 {
 	int_fast8_t new_rdepth_OR, new_rdepth_NR;
 
@@ -219,25 +297,31 @@ static int_fast8_t savl_promote_left(struct savl_node **const subtree)
 
 	/* Rearrange the nodes in the tree */
 	*subtree = NR;
-	NR->parent = OR->parent;
+	savl_set_parent(NR, savl_parent(OR));
 	NR->right = OR;
-	OR->parent = NR;
+	savl_set_parent(OR, NR);
 	OR->left = M;
 	if (M != NULL)
-		M->parent = OR;
+		savl_set_parent(M, OR);
 
 	/*
 	 * The depth and skew of the leftmost, middle, and rightmost subtrees
 	 * didn't change, so use them to calculate the new skew and depth for
 	 * the old and new root nodes.
 	 */
-	OR->skew = rdepth_RM - rdepth_M;
+	savl_set_skew(OR, rdepth_RM - rdepth_M);
 	new_rdepth_OR = savl_rdepth_from_right(OR, rdepth_RM);
 	/* assert(new_rdepth_OR == savl_rdepth_from_left(OR, rdepth_M)); */
-	NR->skew = new_rdepth_OR - rdepth_LM;
+	savl_set_skew(NR, new_rdepth_OR - rdepth_LM);
 	new_rdepth_NR = savl_rdepth_from_left(NR, rdepth_LM);
 	/* assert(new_rdepth_NR == savl_rdepth_from_right(NR, new_rdepth_OR)); */
 
+	/* OR is now NR's child, so it must be updated first */
+	if (aug != NULL) {
+		aug->fn(OR, aug->arg);
+		aug->fn(NR, aug->arg);
+	}
+
 	/* Return change in subtree depth */
 	return new_rdepth_NR - rdepth_OR;
 }
@@ -270,10 +354,12 @@ static int_fast8_t savl_promote_left(struct savl_node **const subtree)
  *
  * @param[in,out] subtree	Double pointer to the root of the subtree.
  *				<b>`*subtree`</b> is set to the new root.
+ * @param aug			Augmentation callback (or <b>`NULL`</b>).
  *
  * @return	The change (if any) to the depth of the subtree.
  */
-static int_fast8_t savl_promote_right(struct savl_node **const subtree)
+static int_fast8_t savl_promote_right(struct savl_node **const subtree,
+				      const struct savl_aug *const aug)
 {
 	int_fast8_t new_rdepth_OR, new_rdepth_NR;
 
@@ -290,29 +376,51 @@ static int_fast8_t savl_promote_right(struct savl_node **const subtree)
 
 	/* Rearrange the nodes in the tree */
 	*subtree = NR;
-	NR->parent = OR->parent;
+	savl_set_parent(NR, savl_parent(OR));
 	NR->left = OR;
-	OR->parent = NR;
+	savl_set_parent(OR, NR);
 	OR->right = M;
 	if (M != NULL)
-		M->parent = OR;
+		savl_set_parent(M, OR);
 
 	/*
 	 * The depth and skew of the rightmost, middle, and leftmost subtrees
 	 * didn't change, so use them to calculate the new skew and rdepth for
 	 * the old and new root nodes.
 	 */
-	OR->skew = rdepth_M - rdepth_LM;
+	savl_set_skew(OR, rdepth_M - rdepth_LM);
 	new_rdepth_OR = savl_rdepth_from_left(OR, rdepth_LM);
 	/* assert(new_rdepth_OR == savl_rdepth_from_right(OR, rdepth_M)); */
-	NR->skew = rdepth_RM - new_rdepth_OR;
+	savl_set_skew(NR, rdepth_RM - new_rdepth_OR);
 	new_rdepth_NR = savl_rdepth_from_right(NR, rdepth_RM);
 	/* assert(new_rdepth_NR == savl_rdepth_from_left(NR, new_rdepth_OR)); */
 
+	if (aug != NULL) {
+		aug->fn(OR, aug->arg);
+		aug->fn(NR, aug->arg);
+	}
+
 	/* Return change in subtree depth */
 	return new_rdepth_NR - rdepth_OR;
 }
 
+/**
+ * Update the augmented data of a node and its ancestors.
+ *
+ * Works upward from <b>`node`</b>, stopping at the root of the tree or at the
+ * first node whose augmented data doesn't change.  (If a node's data doesn't
+ * change, its ancestors' data won't change either.)
+ *
+ * @param node	The lowest node whose subtree has changed (or <b>`NULL`</b>).
+ * @param aug	Augmentation callback.
+ */
+static void savl_aug_propagate(struct savl_node *node,
+			       const struct savl_aug *const aug)
+{
+	while (node != NULL && aug->fn(node, aug->arg))
+		node = savl_parent(node);
+}
+
 /**
  * Search a tree for a key.
  *
@@ -390,6 +498,224 @@ struct savl_node *savl_get(struct savl_node *const tree, const savl_cmpfn cmpfn,
 	return NULL;
 }
 
+/**
+ * Find the first node in a tree whose key is greater than (or equal to) a
+ * key.
+ *
+ * @param node		The root of the tree to be searched.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param inclusive	Does a node whose key is equal to <b>`key`</b> match?
+ *
+ * @return	The matching node (if any), or <b>`NULL`</b>.
+ */
+static struct savl_node *savl_bound_above(struct savl_node *node,
+					  const savl_cmpfn cmpfn,
+					  const union savl_key key,
+					  const _Bool inclusive)
+{
+	struct savl_node *result = NULL;
+	int cmp_result;
+
+	while (node != NULL) {
+
+		cmp_result = cmpfn(key, node);
+
+		if (cmp_result == 0 && inclusive)
+			return node;
+
+		if (cmp_result < 0) {
+			/* node is a candidate; look for a smaller one */
+			result = node;
+			node = node->left;
+		}
+		else {
+			node = node->right;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Find the last node in a tree whose key is less than (or equal to) a key.
+ *
+ * @param node		The root of the tree to be searched.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param inclusive	Does a node whose key is equal to <b>`key`</b> match?
+ *
+ * @return	The matching node (if any), or <b>`NULL`</b>.
+ */
+static struct savl_node *savl_bound_below(struct savl_node *node,
+					  const savl_cmpfn cmpfn,
+					  const union savl_key key,
+					  const _Bool inclusive)
+{
+	struct savl_node *result = NULL;
+	int cmp_result;
+
+	while (node != NULL) {
+
+		cmp_result = cmpfn(key, node);
+
+		if (cmp_result == 0 && inclusive)
+			return node;
+
+		if (cmp_result > 0) {
+			/* node is a candidate; look for a larger one */
+			result = node;
+			node = node->right;
+		}
+		else {
+			node = node->left;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Find the first node in a tree whose key is not less than a key.
+ *
+ * @param tree		The root of the tree to be searched.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The first node whose key is greater than or equal to
+ *		<b>`key`</b> (if any), or <b>`NULL`</b>.
+ */
+struct savl_node *savl_lower_bound(struct savl_node *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key)
+{
+	return savl_bound_above(tree, cmpfn, key, 1);
+}
+
+/**
+ * Find the first node in a tree whose key is greater than a key.
+ *
+ * @param tree		The root of the tree to be searched.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The first node whose key is greater than <b>`key`</b> (if any),
+ *		or <b>`NULL`</b>.
+ */
+struct savl_node *savl_upper_bound(struct savl_node *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key)
+{
+	return savl_bound_above(tree, cmpfn, key, 0);
+}
+
+/**
+ * Find the last node in a tree whose key is not greater than a key.
+ *
+ * @param tree		The root of the tree to be searched.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The last node whose key is less than or equal to <b>`key`</b>
+ *		(if any), or <b>`NULL`</b>.
+ */
+struct savl_node *savl_floor(struct savl_node *const tree,
+			     const savl_cmpfn cmpfn, const union savl_key key)
+{
+	return savl_bound_below(tree, cmpfn, key, 1);
+}
+
+/**
+ * Find the first node in a tree whose key is not less than a key.  (This is
+ * the same node that is returned by savl_lower_bound(); it is provided for
+ * symmetry with savl_floor().)
+ *
+ * @param tree		The root of the tree to be searched.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The first node whose key is greater than or equal to
+ *		<b>`key`</b> (if any), or <b>`NULL`</b>.
+ */
+struct savl_node *savl_ceil(struct savl_node *const tree,
+			    const savl_cmpfn cmpfn, const union savl_key key)
+{
+	return savl_bound_above(tree, cmpfn, key, 1);
+}
+
+/**
+ * Find the nodes that correspond to multiple keys.
+ *
+ * Searching a large tree is largely a sequence of dependent cache misses, one
+ * per level.  This function runs groups of searches in lockstep, prefetching
+ * the next node of every search in the group before comparing any of them, so
+ * that the cache misses of different searches overlap.
+ *
+ * @param tree		The root of the tree to be searched.
+ * @param cmpfn		Comparison function.
+ * @param keys		The keys.
+ * @param count		The number of keys.
+ * @param[out] results	Output array.  On return, each element contains the
+ *			node that corresponds to the key at the same index in
+ *			<b>`keys`</b> (if any), or <b>`NULL`</b>.
+ *
+ * @return	The number of keys that were found.
+ */
+size_t savl_get_batch(struct savl_node *const tree, const savl_cmpfn cmpfn,
+		      const union savl_key *const keys, const size_t count,
+		      struct savl_node **const results)
+{
+	struct savl_node *nodes[SAVL_BATCH_GROUP];
+	size_t active[SAVL_BATCH_GROUP];
+	size_t base, found, i, j, n_active;
+	struct savl_node *node;
+	int cmp_result;
+
+	found = 0;
+
+	for (base = 0; base < count; base += SAVL_BATCH_GROUP) {
+
+		n_active = 0;
+
+		for (i = base; i < count && i < base + SAVL_BATCH_GROUP; ++i) {
+			results[i] = NULL;
+			if (tree != NULL) {
+				nodes[n_active] = tree;
+				active[n_active++] = i;
+			}
+		}
+
+		/* Advance every active search by one level per pass */
+		while (n_active > 0) {
+
+			for (i = 0, j = 0; i < n_active; ++i) {
+
+				node = nodes[i];
+				cmp_result = cmpfn(keys[active[i]], node);
+
+				if (cmp_result == 0) {
+					results[active[i]] = node;
+					++found;
+					continue;
+				}
+
+				node = cmp_result < 0 ? node->left : node->right;
+				if (node == NULL)
+					continue;  /* Not found */
+
+				/* Fetch the child while the others compare */
+				SAVL_PREFETCH(node);
+				nodes[j] = node;
+				active[j++] = active[i];
+			}
+
+			n_active = j;
+		}
+	}
+
+	return found;
+}
+
 /**
  * Replace a node in a tree.
  *
@@ -400,19 +726,21 @@ struct savl_node *savl_get(struct savl_node *const tree, const savl_cmpfn cmpfn,
  * @param[out] tree	A double pointer to the root node of the tree.  If the
  *			the root node is being replaced, <b>`*tree`</b> will be
  *			set to the new root node.
+ * @param aug		Augmentation callback (or <b>`NULL`</b>).
  *
  * @return	The pre-existing node that was replaced.
  */
 static struct savl_node *savl_replace(struct savl_node *const new,
-				      struct savl_node **const tree)
+				      struct savl_node **const tree,
+				      const struct savl_aug *const aug)
 {
-	struct savl_node *const old = new->parent;
+	struct savl_node *const old = savl_parent(new);
 
-	new->parent = old->parent;
+	savl_set_parent(new, savl_parent(old));
 	switch (savl_which_child(old)) {
-		case SAVL_LEFT:		new->parent->left = new;
+		case SAVL_LEFT:		savl_parent(new)->left = new;
 					break;
-		case SAVL_RIGHT:	new->parent->right = new;
+		case SAVL_RIGHT:	savl_parent(new)->right = new;
 					break;
 		case SAVL_EVEN:		*tree = new;
 					break;
@@ -420,45 +748,62 @@ static struct savl_node *savl_replace(struct savl_node *const new,
 
 	new->left = old->left;
 	if (new->left != NULL)
-		new->left->parent = new;
+		savl_set_parent(new->left, new);
 
 	new->right = old->right;
 	if (new->right != NULL)
-		new->right->parent = new;
+		savl_set_parent(new->right, new);
+
+	savl_set_skew(new, savl_skew(old));
 
-	new->skew = old->skew;
+	if (aug != NULL) {
+		aug->fn(new, aug->arg);
+		savl_aug_propagate(savl_parent(new), aug);
+	}
 
 	return old;
 }
 
 /**
- * Rebalance a tree after a new node has been added.
+ * Rebalance a tree after a child subtree has grown.
  *
  * Works upward from <b>`node`</b> to the root of the tree, updating node skews
  * and rebalancing if necessary.
  *
- * @param node		The parent of the newly added node.
+ * After a node has been added, rebalancing always restores the depth of the
+ * rebalanced subtree.  This isn't true when a subtree has grown because trees
+ * were joined (see savl_join_depth()), so growth may continue to propagate
+ * upward after rebalancing.
+ *
+ * @param node		The parent of the newly added node (or the grown
+ *			subtree).
  * @param which_child	Indicates which child was added.
  * @param[out] tree	A double pointer to the root node of the tree.  If the
  *			root of the tree is changed by rebalancing,
  *			<b>`*tree`</b> is set to the new root.
+ * @param aug		Augmentation callback (or <b>`NULL`</b>).
+ *
+ * @return	The change (if any) to the depth of the whole tree.
  */
-static void savl_add_rebalance(struct savl_node *node, int_fast8_t which_child,
-			       struct savl_node **const tree)
+static int_fast8_t savl_add_rebalance(struct savl_node *node,
+				      int_fast8_t which_child,
+				      struct savl_node **const tree,
+				      const struct savl_aug *const aug)
 {
-	int_fast8_t growth;
+	int_fast8_t growth, skew;
 
 	while (node != NULL) {
 
-		node->skew += which_child;
+		skew = savl_skew(node) + which_child;
+		savl_set_skew(node, skew);
 
 		/*
 		 * If node's skew is now even, then it was the (previously)
 		 * shallower child subtree that grew, so the depth of this
 		 * node's subtree hasn't changed
 		 */
-		if (node->skew == SAVL_EVEN)
-			return;
+		if (skew == SAVL_EVEN)
+			return 0;
 
 		which_child = savl_which_child(node);
 
@@ -469,132 +814,148 @@ static void savl_add_rebalance(struct savl_node *node, int_fast8_t which_child,
 		growth = 1;
 
 		/* If skew is still OK (single), propagate growth upward */
-		if (node->skew == SAVL_LEFT || node->skew == SAVL_RIGHT) {
-			node = node->parent;
+		if (skew == SAVL_LEFT || skew == SAVL_RIGHT) {
+			node = savl_parent(node);
 			continue;
 		}
 
-		if (node->skew == SAVL_DBL_LEFT) {
-			if (node->left->skew == SAVL_RIGHT)
-				growth += savl_promote_right(&node->left);
-			growth += savl_promote_left(&node);
+		if (skew == SAVL_DBL_LEFT) {
+			if (savl_skew(node->left) == SAVL_RIGHT)
+				growth += savl_promote_right(&node->left, aug);
+			growth += savl_promote_left(&node, aug);
 		}
 		else {
-			if (node->right->skew == SAVL_LEFT)
-				growth += savl_promote_left(&node->right);
-			growth += savl_promote_right(&node);
+			if (savl_skew(node->right) == SAVL_LEFT)
+				growth += savl_promote_left(&node->right, aug);
+			growth += savl_promote_right(&node, aug);
 		}
 
 		switch (which_child) {
 			case SAVL_EVEN:		*tree = node;
 						break;
-			case SAVL_LEFT:		node->parent->left = node;
+			case SAVL_LEFT:		savl_parent(node)->left = node;
 						break;
-			case SAVL_RIGHT:	node->parent->right = node;
+			case SAVL_RIGHT:	savl_parent(node)->right = node;
 						break;
 		}
 
-		assert(growth == 0);
-		return;
+		/* Only possible when joining trees (see above) */
+		if (growth == 0)
+			return 0;
+
+		assert(growth == 1);
+		node = savl_parent(node);  /* Subtree grew; propagate upward */
 	}
+
+	return 1;
 }
 
 /**
- * Add a node to a tree, potentially replacing a node with an equal key (if
- * any).
+ * Link a node into an augmented tree at a known position.  Otherwise identical
+ * to savl_link().
  *
- * If the tree already contains a node with a key equal to <b>`key`</b>, the
- * behavior is determined by the <b>`replace`</b> parameter.
+ * @param[in,out] tree	A double pointer to the root node of the tree.
+ * @param parent	The new node's parent (or the node that it will replace,
+ *			if <b>`dir`</b> is zero).
+ * @param dir		Which child of <b>`parent`</b> the new node will become
+ *			(or zero to replace <b>`parent`</b>).
+ * @param new		The node to be linked into the tree.
+ * @param aug		Augmentation callback (or <b>`NULL`</b>).
  *
- * @param[in,out] tree	A double pointer to the root node of the tree.  If the
- *			root is changed (by rebalancing, replacement of the root
- *			node, or addition to an empty tree), <b>`*tree`</b> will
- *			be changed to point to the new root node.
- * @param cmpfn		Comparison function.
- * @param key		The key.
- * @param new		The node to be added.  It's key must compare equal to
- *			<b>`key`</b>.
- * @param replace	If the tree already contains a node with a key equal to
- *			<b>`key`</b>, should the new node be inserted in its
- *			place?
+ * @return	The node that was replaced (if <b>`dir`</b> is zero), or
+ *		<b>`NULL`</b>.
  *
- * @return	<b>`NULL`</b> if the tree did not already contain a node with a
- *		key equal to <b>`key`</b>, or a pointer to the pre-existing
- *		key (which may have been replaced, depending on the value of
- *		the <b>`replace`</b> parameter).
+ * @see	savl_aug
+ * @see	savl_link
  */
-struct savl_node *savl_add(struct savl_node **const tree,
-			   const savl_cmpfn cmpfn, const union savl_key key,
-			   struct savl_node *const new, const _Bool replace)
+struct savl_node *savl_aug_link(struct savl_node **const tree,
+				struct savl_node *const parent, const int dir,
+				struct savl_node *const new,
+				const struct savl_aug *const aug)
 {
 	int_fast8_t which_child;
 
 	new->left = NULL;
 	new->right = NULL;
-	new->skew = SAVL_EVEN;
+	savl_set_skew(new, SAVL_EVEN);
+	savl_set_parent(new, parent);
 
 	/* If tree is empty, new node becomes the root node */
-	if (*tree == NULL) {
-		new->parent = NULL;
+	if (parent == NULL) {
+		assert(*tree == NULL);
 		*tree = new;
+		if (aug != NULL)
+			aug->fn(new, aug->arg);
 		return NULL;
 	}
 
-	/* Find existing node with equal key or prospective parent */
-	which_child = savl_search(*tree, cmpfn, key, &new->parent);
+	if (dir == 0)
+		return savl_replace(new, tree, aug);  /* returns old node */
 
-	/*
-	 * If node with equal key already exists, replace it (if asked) and
-	 * return the pre-existing node.
-	 */
-	if (which_child == SAVL_EVEN) {
-		if (replace)
-			return savl_replace(new, tree);  /* returns old node */
-		else
-			return new->parent;  /* new->parent == old node */
-	}
+	if (aug != NULL)
+		aug->fn(new, aug->arg);
 
 	/* Add new node to tree */
-	if (which_child == SAVL_LEFT) {
-		assert(new->parent->left == NULL);
-		new->parent->left = new;
+	if (dir < 0) {
+		assert(parent->left == NULL);
+		parent->left = new;
+		which_child = SAVL_LEFT;
 	}
 	else {
-		assert(new->parent->right == NULL);
-		new->parent->right = new;
+		assert(parent->right == NULL);
+		parent->right = new;
+		which_child = SAVL_RIGHT;
 	}
 
+	if (aug != NULL)
+		savl_aug_propagate(parent, aug);
+
 	/* Adjust parent's skew and rebalance tree */
-	savl_add_rebalance(new->parent, which_child, tree);
+	savl_add_rebalance(parent, which_child, tree, aug);
 
 	return NULL;
 }
 
 /**
- * Add a node to a tree, if the tree does not already contain a node with the
- * same key.
+ * Link a node into a tree at a known position.
+ *
+ * This is the second half of an insertion; the first half is a search that
+ * determines the new node's prospective parent and which of the parent's
+ * children it will become.  It is used by the code generated by
+ * {@link SAVL_GENERATE}, which performs its own (inlined) search.
  *
  * @param[in,out] tree	A double pointer to the root node of the tree.  If the
  *			root is changed (by rebalancing, replacement of the root
  *			node, or addition to an empty tree), <b>`*tree`</b> will
  *			be changed to point to the new root node.
- * @param cmpfn		Comparison function.
- * @param key		The key.
- * @param new		The node to be added.  It's key must compare equal to
- *			<b>`key`</b>.
+ * @param parent	The new node's parent (or the node that it will replace,
+ *			if <b>`dir`</b> is zero).  Must be <b>`NULL`</b> if (and
+ *			only if) the tree is empty.
+ * @param dir		The result of comparing the new node's key with
+ *			<b>`parent`</b>; a value less than zero causes the new
+ *			node to be linked as <b>`parent`</b>'s left child, a
+ *			value greater than zero causes it to be linked as
+ *			<b>`parent`</b>'s right child, and zero causes it to
+ *			replace <b>`parent`</b>.  (The corresponding child
+ *			pointer of <b>`parent`</b> must be <b>`NULL`</b>.)
+ * @param new		The node to be linked into the tree.
  *
- * @return	<b>`NULL`</b> if the node was added, or a pointer to the
- *		pre-existing node with an equal key.
+ * @return	The node that was replaced (if <b>`dir`</b> is zero), or
+ *		<b>`NULL`</b>.
  */
-struct savl_node *savl_try_add(struct savl_node **const tree,
-			       const savl_cmpfn cmpfn, const union savl_key key,
-			       struct savl_node *const new)
+struct savl_node *savl_link(struct savl_node **const tree,
+			    struct savl_node *const parent, const int dir,
+			    struct savl_node *const new)
 {
-	return savl_add(tree, cmpfn, key, new, 0);
+	return savl_aug_link(tree, parent, dir, new, NULL);
 }
 
 /**
- * Add a node to the tree, replacing a node with an equal key (if any).
+ * Add a node to a tree, potentially replacing a node with an equal key (if
+ * any).
+ *
+ * If the tree already contains a node with a key equal to <b>`key`</b>, the
+ * behavior is determined by the <b>`replace`</b> parameter.
  *
  * @param[in,out] tree	A double pointer to the root node of the tree.  If the
  *			root is changed (by rebalancing, replacement of the root
@@ -604,44 +965,430 @@ struct savl_node *savl_try_add(struct savl_node **const tree,
  * @param key		The key.
  * @param new		The node to be added.  It's key must compare equal to
  *			<b>`key`</b>.
+ * @param replace	If the tree already contains a node with a key equal to
+ *			<b>`key`</b>, should the new node be inserted in its
+ *			place?
  *
- * @return	The node that was replaced (if any), or <b>`NULL`</b>.
+ * @return	<b>`NULL`</b> if the tree did not already contain a node with a
+ *		key equal to <b>`key`</b>, or a pointer to the pre-existing
+ *		key (which may have been replaced, depending on the value of
+ *		the <b>`replace`</b> parameter).
  */
-struct savl_node *savl_force_add(struct savl_node **const tree,
-				 const savl_cmpfn cmpfn,
-				 const union savl_key key,
-				 struct savl_node *const new)
+struct savl_node *savl_add(struct savl_node **const tree,
+			   const savl_cmpfn cmpfn, const union savl_key key,
+			   struct savl_node *const new, const _Bool replace)
 {
-	return savl_add(tree, cmpfn, key, new, 1);
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	/* Find existing node with equal key or prospective parent */
+	which_child = savl_search(*tree, cmpfn, key, &parent);
+
+	/*
+	 * If node with equal key already exists, return it (unless asked to
+	 * replace it).
+	 */
+	if (which_child == SAVL_EVEN && parent != NULL && !replace)
+		return parent;
+
+	return savl_link(tree, parent, which_child, new);
 }
 
 /**
- * Rebalance a tree after a node has been deleted.
+ * Search a tree for a key, starting at a "hint" node.
  *
- * Works upward from <b>`node`</b> to the root of the tree, updating node skews
- * and rebalancing if necessary.
+ * Rather than searching from the root of the tree, the search begins at
+ * <b>`hint`</b> and climbs only as far as necessary to reach a subtree whose
+ * range of keys includes <b>`key`</b>.  Keys are compared only with nodes
+ * between <b>`hint`</b> and the key's position, but finding the ancestor that
+ * bounds a subtree follows parent pointers, so the climb is O(log n) in the
+ * worst case.  If the caller knows the first and last nodes of the tree, it
+ * passes them in <b>`first`</b> and <b>`last`</b>, and the climb stops at
+ * either of them, because their subtrees are unbounded on one side.
  *
- * @param node		The parent of the deleted node.
- * @param which_child	Indicates which child subtree shrank.
- * @param[out] tree	A double pointer to the root node of the tree.  If the
- *			root of the tree is changed by rebalancing,
- *			<b>`*tree`</b> is set to the new root.
+ * @param root		The root of the tree (used only if <b>`hint`</b> is
+ *			<b>`NULL`</b>).
+ * @param hint		A node in the tree, or <b>`NULL`</b>.
+ * @param first		The first node of the tree, or <b>`NULL`</b> (if
+ *			unknown).
+ * @param last		The last node of the tree, or <b>`NULL`</b> (if
+ *			unknown).
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param[out] result	Output parameter used to return the key's node (or its
+ *			prospective parent).
+ *
+ * @return	The key's position relative to <b>`*result`</b>, as returned
+ *		by savl_search().
+ *
+ * @see	savl_search
  */
-static void savl_del_rebalance(struct savl_node *node, int_fast8_t which_child,
-			       struct savl_node **const tree)
+static int_fast8_t savl_search_hint(struct savl_node *const root,
+				    struct savl_node *const hint,
+				    const struct savl_node *const first,
+				    const struct savl_node *const last,
+				    const savl_cmpfn cmpfn,
+				    const union savl_key key,
+				    struct savl_node **const result)
 {
-	int_fast8_t growth;
+	struct savl_node *node, *bound, *child;
+	const struct savl_node *edge;
+	int_fast8_t dir, which_child;
+	int cmp_result;
 
-	while (node != NULL) {
+	if (hint == NULL)
+		return savl_search(root, cmpfn, key, result);
 
-		node->skew -= which_child;
+	cmp_result = cmpfn(key, hint);
+	if (cmp_result == 0) {
+		*result = hint;
+		return SAVL_EVEN;
+	}
+
+	dir = cmp_result < 0 ? SAVL_LEFT : SAVL_RIGHT;
+	edge = dir == SAVL_LEFT ? first : last;
+	node = hint;
+
+	/*
+	 * The key is on the dir side of node.  Find the nearest ancestor that
+	 * bounds node's subtree on that side; if the key is also on the dir
+	 * side of that ancestor, it becomes the new starting point.
+	 */
+	while (node != edge) {
+
+		bound = node;
+		while ((which_child = savl_which_child(bound)) == dir)
+			bound = savl_parent(bound);
+
+		if (which_child == SAVL_EVEN)
+			break;  /* Subtree is unbounded on the dir side */
+
+		bound = savl_parent(bound);
+		cmp_result = cmpfn(key, bound);
+
+		if (cmp_result == 0) {
+			*result = bound;
+			return SAVL_EVEN;
+		}
+
+		if ((cmp_result < 0 ? SAVL_LEFT : SAVL_RIGHT) != dir)
+			break;
+
+		node = bound;
+	}
+
+	/* Key belongs in node's dir subtree */
+	child = dir == SAVL_LEFT ? node->left : node->right;
+
+	if (child == NULL) {
+		*result = node;
+		return dir;
+	}
+
+	return savl_search(child, cmpfn, key, result);
+}
+
+/**
+ * Add a node to a tree, if the tree does not already contain a node with the
+ * same key, starting the search at a "hint" node.
+ *
+ * Rather than searching from the root of the tree, the search begins at
+ * <b>`hint`</b> and climbs only as far as necessary to reach a subtree whose
+ * range of keys includes <b>`key`</b>.  Keys are compared only with nodes
+ * between <b>`hint`</b> and the new node's position, so adding a node next to
+ * the hint requires only one or two comparisons.  The climb itself follows
+ * parent pointers, however, and it is O(log n) in the worst case.  In
+ * particular, adding a new largest key with the result of savl_last() as the
+ * hint climbs to the root every time.  (savl_tree_add_hint() makes such
+ * appends O(1), by stopping at the first or last node of the tree.)
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing or addition to an empty
+ *			tree), <b>`*tree`</b> will be changed to point to the
+ *			new root node.
+ * @param hint		A node in the tree whose key is close to <b>`key`</b>,
+ *			or <b>`NULL`</b> (to search from the root).
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added.  It's key must compare equal to
+ *			<b>`key`</b>.
+ *
+ * @return	<b>`NULL`</b> if the node was added, or a pointer to the
+ *		pre-existing node with an equal key.
+ */
+struct savl_node *savl_add_hint(struct savl_node **const tree,
+				struct savl_node *const hint,
+				const savl_cmpfn cmpfn,
+				const union savl_key key,
+				struct savl_node *const new)
+{
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	which_child = savl_search_hint(*tree, hint, NULL, NULL,
+				       cmpfn, key, &parent);
+
+	if (which_child == SAVL_EVEN && parent != NULL)
+		return parent;
+
+	return savl_link(tree, parent, which_child, new);
+}
+
+/**
+ * Add a node to a tree, if the tree does not already contain a node with the
+ * same key.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing, replacement of the root
+ *			node, or addition to an empty tree), <b>`*tree`</b> will
+ *			be changed to point to the new root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added.  It's key must compare equal to
+ *			<b>`key`</b>.
+ *
+ * @return	<b>`NULL`</b> if the node was added, or a pointer to the
+ *		pre-existing node with an equal key.
+ */
+struct savl_node *savl_try_add(struct savl_node **const tree,
+			       const savl_cmpfn cmpfn, const union savl_key key,
+			       struct savl_node *const new)
+{
+	return savl_add(tree, cmpfn, key, new, 0);
+}
+
+/**
+ * Add a node to the tree, replacing a node with an equal key (if any).
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing, replacement of the root
+ *			node, or addition to an empty tree), <b>`*tree`</b> will
+ *			be changed to point to the new root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added.  It's key must compare equal to
+ *			<b>`key`</b>.
+ *
+ * @return	The node that was replaced (if any), or <b>`NULL`</b>.
+ */
+struct savl_node *savl_force_add(struct savl_node **const tree,
+				 const savl_cmpfn cmpfn,
+				 const union savl_key key,
+				 struct savl_node *const new)
+{
+	return savl_add(tree, cmpfn, key, new, 1);
+}
+
+/**
+ * Search a tree for a key, and record the position at which a node with the key
+ * would be added.
+ *
+ * This is the first half of a two-phase insertion; the second half is
+ * savl_link_at().  The tree must not be modified between the two calls.
+ *
+ * @param tree		A double pointer to the root node of the tree.  (The
+ *			pointer is recorded in <b>`*point`</b>, for use by
+ *			savl_link_at().)
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param[out] point	Output parameter used to return the insertion point.
+ *
+ * @return	The node with a matching key (or <b>`NULL`</b> if the tree does
+ *		not contain a matching node).  If a node is returned, the
+ *		insertion point refers to it, and savl_link_at() will replace
+ *		it.
+ *
+ * @see	savl_point
+ */
+struct savl_node *savl_locate(struct savl_node **const tree,
+			      const savl_cmpfn cmpfn, const union savl_key key,
+			      struct savl_point *const point)
+{
+	int_fast8_t which_child;
+
+	which_child = savl_search(*tree, cmpfn, key, &point->node);
+
+	point->tree = tree;
+	point->handle = NULL;
+	point->dir = which_child;
+
+	if (which_child == SAVL_EVEN)
+		return point->node;	/* NULL if tree is empty */
+
+	return NULL;
+}
+
+/**
+ * Link a node into a tree at an insertion point found by savl_locate() or
+ * savl_tree_locate().  (If the insertion point was found by
+ * savl_tree_locate(), the tree's handle is updated.)
+ *
+ * @param point	The insertion point.
+ * @param new	The node to be linked into the tree.  Its key must compare
+ *		equal to the key that was passed to savl_locate().
+ *
+ * @return	The node that was replaced (if savl_locate() found a node with
+ *		a matching key), or <b>`NULL`</b>.
+ *
+ * @see	savl_point
+ */
+struct savl_node *savl_link_at(const struct savl_point *const point,
+			       struct savl_node *const new)
+{
+	if (point->handle != NULL) {
+		return savl_tree_link(point->handle, point->node, point->dir,
+				      new);
+	}
+
+	return savl_link(point->tree, point->node, point->dir, new);
+}
+
+/**
+ * Add a node to each of several trees, only if none of the trees already
+ * contains a node with the corresponding key.
+ *
+ * All of the trees are searched before any of them are modified, so each tree
+ * is searched only once, and nothing needs to be undone if a key conflicts.
+ * For example, to add a structure that is indexed by both name and number:
+ *
+ *	struct savl_multi_entry entries[2] = {
+ *		{
+ *			.tree	= &by_name,
+ *			.cmpfn	= cmp_names,
+ *			.key	= { .p = emp },
+ *			.node	= &emp->name_node
+ *		},
+ *		{
+ *			.tree	= &by_number,
+ *			.cmpfn	= cmp_numbers,
+ *			.key	= { .u = emp->number },
+ *			.node	= &emp->number_node
+ *		}
+ *	};
+ *
+ *	if (savl_multi_add(entries, 2, NULL) != NULL)
+ *		... name or number already exists ...
+ *
+ * The trees must all be different.  Trees with a {@link savl_tree} handle are
+ * identified by the entry's <b>`handle`</b> member (rather than its
+ * <b>`tree`</b> member), and their handles are kept up to date.
+ *
+ * @param entries	The trees, comparison functions, keys, and nodes.
+ * @param count		The number of entries.
+ * @param[out] index	Output parameter used to return the index of the first
+ *			entry whose key conflicts with an existing node (or
+ *			<b>`NULL`</b>).  Not changed if no keys conflict.
+ *
+ * @return	<b>`NULL`</b> if the nodes were added, or the first existing
+ *		node whose key conflicts.
+ *
+ * @see	savl_multi_entry
+ */
+struct savl_node *savl_multi_add(struct savl_multi_entry *const entries,
+				 const size_t count, size_t *const index)
+{
+	struct savl_multi_entry *e;
+	struct savl_node *existing;
+	size_t i;
+
+	for (i = 0; i < count; ++i) {
+
+		e = &entries[i];
+
+		if (e->handle != NULL) {
+			existing = savl_tree_locate(e->handle, e->cmpfn, e->key,
+						    &e->point);
+		}
+		else {
+			existing = savl_locate(e->tree, e->cmpfn, e->key,
+					       &e->point);
+		}
+
+		if (existing != NULL) {
+			if (index != NULL)
+				*index = i;
+			return existing;
+		}
+	}
+
+	for (i = 0; i < count; ++i)
+		savl_link_at(&entries[i].point, entries[i].node);
+
+	return NULL;
+}
+
+/**
+ * Find the node with a key, or create and add one if the tree does not contain
+ * one.
+ *
+ * The tree is searched only once, and <b>`ctor`</b> is called only if the key
+ * is not found.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing or addition to an empty
+ *			tree), <b>`*tree`</b> will be changed to point to the
+ *			new root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param ctor		Constructor callback, which is called to create the new
+ *			node.  Its key must compare equal to <b>`key`</b>.
+ * @param ctx		Context argument passed to <b>`ctor`</b>.
+ *
+ * @return	The existing node, the new node, or <b>`NULL`</b> (if
+ *		<b>`ctor`</b> returned <b>`NULL`</b>).
+ *
+ * @see	savl_ctorfn
+ */
+struct savl_node *savl_find_or_insert(struct savl_node **const tree,
+				      const savl_cmpfn cmpfn,
+				      const union savl_key key,
+				      const savl_ctorfn ctor, void *const ctx)
+{
+	struct savl_node *parent, *new;
+	int_fast8_t which_child;
+
+	which_child = savl_search(*tree, cmpfn, key, &parent);
+
+	if (which_child == SAVL_EVEN && parent != NULL)
+		return parent;
+
+	new = ctor(key, ctx);
+	if (new != NULL)
+		savl_link(tree, parent, which_child, new);
+
+	return new;
+}
+
+/**
+ * Rebalance a tree after a node has been deleted.
+ *
+ * Works upward from <b>`node`</b> to the root of the tree, updating node skews
+ * and rebalancing if necessary.
+ *
+ * @param node		The parent of the deleted node.
+ * @param which_child	Indicates which child subtree shrank.
+ * @param[out] tree	A double pointer to the root node of the tree.  If the
+ *			root of the tree is changed by rebalancing,
+ *			<b>`*tree`</b> is set to the new root.
+ * @param aug		Augmentation callback (or <b>`NULL`</b>).
+ */
+static void savl_del_rebalance(struct savl_node *node, int_fast8_t which_child,
+			       struct savl_node **const tree,
+			       const struct savl_aug *const aug)
+{
+	int_fast8_t growth, skew;
+
+	while (node != NULL) {
+
+		skew = savl_skew(node) - which_child;
+		savl_set_skew(node, skew);
 
 		/*
 		 * If node is not even, then its shallower subtree was the one
 		 * that shrank, and its depth hasn't changed.  If it's singly
 		 * skewed, no further rebalancing is needed.
 		 */
-		if (node->skew == SAVL_LEFT || node->skew == SAVL_RIGHT)
+		if (skew == SAVL_LEFT || skew == SAVL_RIGHT)
 			return;
 
 		which_child = savl_which_child(node);
@@ -650,31 +1397,31 @@ static void savl_del_rebalance(struct savl_node *node, int_fast8_t which_child,
 		 * If node is now evenly skewed, then its deeper subtree shrank,
 		 * so this node's subtree also shrank.  Propagate upward.
 		 */
-		if (node->skew == SAVL_EVEN) {
-			node = node->parent;
+		if (skew == SAVL_EVEN) {
+			node = savl_parent(node);
 			continue;
 		}
 
 		/* Node is doubly skewed, so depth didn't change (see above) */
 		growth = 0;
 
-		if (node->skew == SAVL_DBL_LEFT) {
-			if (node->left->skew == SAVL_RIGHT)
-				growth += savl_promote_right(&node->left);
-			growth += savl_promote_left(&node);
+		if (skew == SAVL_DBL_LEFT) {
+			if (savl_skew(node->left) == SAVL_RIGHT)
+				growth += savl_promote_right(&node->left, aug);
+			growth += savl_promote_left(&node, aug);
 		}
 		else {
-			if (node->right->skew == SAVL_LEFT)
-				growth += savl_promote_left(&node->right);
-			growth += savl_promote_right(&node);
+			if (savl_skew(node->right) == SAVL_LEFT)
+				growth += savl_promote_left(&node->right, aug);
+			growth += savl_promote_right(&node, aug);
 		}
 
 		switch (which_child) {
 			case SAVL_EVEN:		*tree = node;
 						break;
-			case SAVL_LEFT:		node->parent->left = node;
+			case SAVL_LEFT:		savl_parent(node)->left = node;
 						break;
-			case SAVL_RIGHT:	node->parent->right = node;
+			case SAVL_RIGHT:	savl_parent(node)->right = node;
 						break;
 		}
 
@@ -683,7 +1430,8 @@ static void savl_del_rebalance(struct savl_node *node, int_fast8_t which_child,
 			return;
 
 		assert(growth == -1);
-		node = node->parent;  /* Subtree shrank; propagate upward */
+		/* Subtree shrank; propagate upward */
+		node = savl_parent(node);
 	}
 }
 
@@ -695,9 +1443,11 @@ static void savl_del_rebalance(struct savl_node *node, int_fast8_t which_child,
  *			root node is changed (because it is deleted or the tree
  *			is rebalanced), <b>`*tree`</b> will be set to the new
  *			root node.
+ * @param aug		Augmentation callback (or <b>`NULL`</b>).
  */
 static void savl_del_simple(struct savl_node *const node,
-			    struct savl_node **const tree)
+			    struct savl_node **const tree,
+			    const struct savl_aug *const aug)
 {
 	struct savl_node *repl;
 	int_fast8_t which_child;
@@ -708,20 +1458,23 @@ static void savl_del_simple(struct savl_node *const node,
 		repl = node->right;  /* NULL if leaf node */
 
 	if (repl != NULL)
-		repl->parent = node->parent;
+		savl_set_parent(repl, savl_parent(node));
 
 	which_child = savl_which_child(node);
 
 	switch (which_child) {
 		case SAVL_EVEN:		*tree = repl;
 					return;
-		case SAVL_LEFT:		node->parent->left = repl;
+		case SAVL_LEFT:		savl_parent(node)->left = repl;
 					break;
-		case SAVL_RIGHT:	node->parent->right = repl;
+		case SAVL_RIGHT:	savl_parent(node)->right = repl;
 					break;
 	}
 
-	savl_del_rebalance(node->parent, which_child, tree);
+	if (aug != NULL)
+		savl_aug_propagate(savl_parent(node), aug);
+
+	savl_del_rebalance(savl_parent(node), which_child, tree, aug);
 }
 
 /**
@@ -766,21 +1519,21 @@ static struct savl_node *savl_left_repl(const struct savl_node *const node)
 	/* Replacement's left child (if any) takes its place */
 	if (which_child == SAVL_LEFT) {
 		/* Replacement is node's immediate left child */
-		repl->parent->left = repl->left;
+		savl_parent(repl)->left = repl->left;
 		if (repl->left != NULL)
-			repl->left->parent = repl->parent;
+			savl_set_parent(repl->left, savl_parent(repl));
 		/* Must point to node where rebalancing will start */
-		repl->parent = repl;
+		savl_set_parent(repl, repl);
 	}
 	else {
 		/* Replacement is a right child in node's left subtree */
-		repl->parent->right = repl->left;
+		savl_parent(repl)->right = repl->left;
 		if (repl->left != NULL)
-			repl->left->parent = repl->parent;
+			savl_set_parent(repl->left, savl_parent(repl));
 	}
 
 	/* Temporarily "stash" which_child value in replacement's skew */
-	repl->skew = which_child;
+	savl_set_skew(repl, which_child);
 
 	return repl;
 }
@@ -826,21 +1579,21 @@ static struct savl_node *savl_right_repl(struct savl_node *node)
 	/* Replacement's right child (if any) takes its place */
 	if (which_child == SAVL_RIGHT) {
 		/* Replacement is to be deleted node's immediate right child */
-		node->parent->right = node->right;
+		savl_parent(node)->right = node->right;
 		if (node->right != NULL)
-			node->right->parent = node->parent;
+			savl_set_parent(node->right, savl_parent(node));
 		/* node->parent must point to where rebalancing will start */
-		node->parent = node;
+		savl_set_parent(node, node);
 	}
 	else {
 		/* Replacement is a left child deeper in node's right subtree */
-		node->parent->left = node->right;
+		savl_parent(node)->left = node->right;
 		if (node->right != NULL)
-			node->right->parent = node->parent;
+			savl_set_parent(node->right, savl_parent(node));
 	}
 
 	/* Temporarily "stash" which_child value in replacement's skew */
-	node->skew = which_child;
+	savl_set_skew(node, which_child);
 
 	return node;
 }
@@ -853,20 +1606,48 @@ static struct savl_node *savl_right_repl(struct savl_node *node)
  *			root node is changed (because it is deleted or the tree
  *			is rebalanced), <b>`*tree`</b> will be set to the new
  *			root node.
+ * @param aug		Augmentation callback (or <b>`NULL`</b>).
+ * @param repl_dir	The subtree from which the replacement node must be
+ *			taken (<b>`SAVL_LEFT`</b> for the node's predecessor or
+ *			<b>`SAVL_RIGHT`</b> for its successor), or
+ *			<b>`SAVL_EVEN`</b> to choose the deeper subtree.
+ * @param which_repl	State used to alternate between subtrees when they are
+ *			equally deep (or <b>`NULL`</b>).
+ *
+ * @return	The replacement node.
  */
-static void savl_del_complex(struct savl_node *const node,
-			     struct savl_node **const tree)
+static struct savl_node *savl_del_complex(struct savl_node *const node,
+					  struct savl_node **const tree,
+					  const struct savl_aug *const aug,
+					  const int_fast8_t repl_dir,
+					  _Bool *const which_repl)
 {
-	static _Bool which_repl;
-
-	struct savl_node *repl, *repl_parent;
+	struct savl_node *repl, *repl_parent, *n;
 	int_fast8_t which_child, which_subtree;
+	uintptr_t addr;
 
 	/* Get replacement from deeper subtree (if any) or just alternate */
-	which_subtree = node->skew;
+	which_subtree = repl_dir != SAVL_EVEN ? repl_dir : savl_skew(node);
 	if (which_subtree == SAVL_EVEN) {
-		which_repl = !which_repl;
-		which_subtree = which_repl ? SAVL_LEFT : SAVL_RIGHT;
+		if (which_repl != NULL) {
+			*which_repl = !*which_repl;
+			which_subtree = *which_repl ? SAVL_LEFT : SAVL_RIGHT;
+		}
+		else {
+			/*
+			 * No state to alternate with, so use the top bit of a
+			 * multiplicative hash of the node's address, which
+			 * depends on all of the address bits.  (Nodes that are
+			 * allocated in an array, at a power-of-2 stride, still
+			 * get a well mixed sequence of choices.)
+			 */
+			addr = (uintptr_t)node
+				* (uintptr_t)UINT64_C(0x9e3779b97f4a7c15);
+			if (addr >> (sizeof addr * CHAR_BIT - 1))
+				which_subtree = SAVL_LEFT;
+			else
+				which_subtree = SAVL_RIGHT;
+		}
 	}
 
 	if (which_subtree == SAVL_LEFT)
@@ -874,36 +1655,97 @@ static void savl_del_complex(struct savl_node *const node,
 	else
 		repl = savl_right_repl(node);
 
-	which_child = repl->skew;
-	repl_parent = repl->parent;
+	which_child = savl_skew(repl);
+	repl_parent = savl_parent(repl);
 
 	switch (savl_which_child(node)) {
 		case SAVL_EVEN:		*tree = repl;
 					break;
-		case SAVL_LEFT:		node->parent->left = repl;
+		case SAVL_LEFT:		savl_parent(node)->left = repl;
 					break;
-		case SAVL_RIGHT:	node->parent->right = repl;
+		case SAVL_RIGHT:	savl_parent(node)->right = repl;
 					break;
 	}
 
-	repl->parent = node->parent;
+	savl_set_parent(repl, savl_parent(node));
 
 	repl->left = node->left;
 	if (repl->left != NULL)
-		repl->left->parent = repl;
+		savl_set_parent(repl->left, repl);
 
 	repl->right = node->right;
 	if (repl->right != NULL)
-		repl->right->parent = repl;
+		savl_set_parent(repl->right, repl);
+
+	savl_set_skew(repl, savl_skew(node));
+
+	/*
+	 * Every node from the replacement's former parent up to its new
+	 * position must be updated, even if some of them don't change.  (The
+	 * replacement's data was calculated for its former position.)
+	 */
+	if (aug != NULL) {
+		for (n = repl_parent; n != repl; n = savl_parent(n))
+			aug->fn(n, aug->arg);
+		aug->fn(repl, aug->arg);
+		savl_aug_propagate(savl_parent(repl), aug);
+	}
+
+	savl_del_rebalance(repl_parent, which_child, tree, aug);
+
+	return repl;
+}
+
+/**
+ * Remove a node from a tree, updating augmented data.
+ *
+ * @param node		The node to be deleted.
+ * @param[out] tree	A double pointer to the root node of the tree.
+ * @param aug		Augmentation callback (or <b>`NULL`</b>).
+ * @param repl_dir	If <b>`node`</b> has 2 children, the subtree from which
+ *			its replacement must be taken (see savl_del_complex()).
+ * @param which_repl	Replacement alternation state (or <b>`NULL`</b>).
+ *
+ * @return	The node that took <b>`node`</b>'s place, if it had 2
+ *		children, or <b>`NULL`</b>.
+ *
+ * @see	savl_remove_node
+ */
+static struct savl_node *savl_remove_aug(struct savl_node *const node,
+					 struct savl_node **const tree,
+					 const struct savl_aug *const aug,
+					 const int_fast8_t repl_dir,
+					 _Bool *const which_repl)
+{
+	struct savl_node *repl;
+
+	if (node->left == NULL || node->right == NULL) {
+		savl_del_simple(node, tree, aug);
+		repl = NULL;
+	}
+	else {
+		repl = savl_del_complex(node, tree, aug, repl_dir, which_repl);
+	}
 
-	repl->skew = node->skew;
+	savl_set_parent(node, NULL);
+	node->left = NULL;
+	node->right = NULL;
+	savl_set_skew(node, SAVL_EVEN);
 
-	savl_del_rebalance(repl_parent, which_child, tree);
+	return repl;
 }
 
 /**
  * Remove a node from the tree.
  *
+ * Deletion (like every other operation) uses no global state, so different
+ * threads can safely delete nodes from different trees at the same time.
+ *
+ * When a node with 2 subtrees is deleted, its replacement is taken from the
+ * deeper subtree.  If the subtrees are equally deep, a hash of the node's
+ * address chooses between them.  (savl_tree_remove_node() alternates between
+ * them, using state kept in the tree's handle.)
+ *
  * @param node		The node to be deleted.
  * @param[out] tree	A double pointer to the root node of the tree.  If the
  *			root node is changed (because it is deleted or the tree
@@ -913,77 +1755,337 @@ static void savl_del_complex(struct savl_node *const node,
 void savl_remove_node(struct savl_node *const node,
 		      struct savl_node **const tree)
 {
-	if (node->left == NULL || node->right == NULL)
-		savl_del_simple(node, tree);
-	else
-		savl_del_complex(node, tree);
-
-	node->parent = NULL;
-	node->left = NULL;
-	node->right = NULL;
-	node->skew = SAVL_EVEN;
+	savl_remove_aug(node, tree, NULL, SAVL_EVEN, NULL);
 }
 
 /**
- * Remove a key from the tree.
+ * Remove a node from the tree, and return the node that followed it.
  *
- * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ * If the node has 2 children, it is replaced by its successor, which is found
+ * during the deletion.  This allows a loop to remove nodes as it iterates
+ * through a tree without searching for each successor separately.  For
+ * example:
+ *
+ *	node = savl_first(tree);
+ *
+ *	while (node != NULL) {
+ *		if (is_expired(node))
+ *			node = savl_remove_node_next(node, &tree);
+ *		else
+ *			node = savl_next(node);
+ *	}
+ *
+ * @param node		The node to be deleted.
+ * @param[out] tree	A double pointer to the root node of the tree.  If the
  *			root node is changed (because it is deleted or the tree
  *			is rebalanced), <b>`*tree`</b> will be set to the new
  *			root node.
- * @param cmpfn		Comparison function.
- * @param key		The key.
  *
- * @return	The node that was removed (or <b>`NULL`</b> if the tree did not
- *		contain a matching node.
+ * @return	The node that followed the deleted node (or <b>`NULL`</b> if
+ *		the deleted node was the last node in the tree).
  */
-struct savl_node *savl_remove(struct savl_node **const tree,
-			      const savl_cmpfn cmpfn, const union savl_key key)
+struct savl_node *savl_remove_node_next(struct savl_node *const node,
+					struct savl_node **const tree)
 {
-	struct savl_node *node;
+	struct savl_node *next;
 
-	if (savl_search(*tree, cmpfn, key, &node) != SAVL_EVEN || node == NULL)
-		return NULL;
+	if (node->left != NULL && node->right != NULL)
+		return savl_remove_aug(node, tree, NULL, SAVL_RIGHT, NULL);
 
-	savl_remove_node(node, tree);
+	next = savl_next(node);
+	savl_remove_aug(node, tree, NULL, SAVL_EVEN, NULL);
 
-	return node;
+	return next;
 }
 
 /**
- * Find the first node in a tree (or subtree).
+ * Remove a node from the tree, and return the node that preceded it.
  *
- * @param node	The tree (or subtree).
+ * See savl_remove_node_next().
  *
- * @return	The first node in the (sub)tree.
+ * @param node		The node to be deleted.
+ * @param[out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed (because it is deleted or the tree
+ *			is rebalanced), <b>`*tree`</b> will be set to the new
+ *			root node.
+ *
+ * @return	The node that preceded the deleted node (or <b>`NULL`</b> if
+ *		the deleted node was the first node in the tree).
  */
-struct savl_node *savl_first(struct savl_node *node)
+struct savl_node *savl_remove_node_prev(struct savl_node *const node,
+					struct savl_node **const tree)
 {
-	if (node == NULL)
-		return NULL;
+	struct savl_node *prev;
 
-	while (node->left != NULL)
-		node = node->left;
+	if (node->left != NULL && node->right != NULL)
+		return savl_remove_aug(node, tree, NULL, SAVL_LEFT, NULL);
 
-	return node;
+	prev = savl_prev(node);
+	savl_remove_aug(node, tree, NULL, SAVL_EVEN, NULL);
+
+	return prev;
 }
 
 /**
- * Find the last node in a tree (or subtree).
+ * Find the new position of a node whose key has changed.
  *
- * @param node	The tree (or subtree).
+ * The new key is compared with the keys of the node's predecessor and
+ * successor.  If it is still between them, the node's position is unchanged.
+ * Otherwise, the tree is searched starting at the neighbor in the direction
+ * that the node moved.  The search covers only keys on the far side of that
+ * neighbor, so it never compares the key with the node itself.
  *
- * @return	The last node in the (sub)tree.
+ * @param node		The node whose key has changed.
+ * @param first		The first node of the tree, or <b>`NULL`</b> (see
+ *			savl_search_hint()).
+ * @param last		The last node of the tree, or <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.
+ * @param key		The node's new key.
+ * @param[out] result	Output parameter used to return the node's new parent,
+ *			a node with a key equal to <b>`key`</b>, or
+ *			<b>`NULL`</b> (if the node's position is unchanged).
+ *
+ * @return	Which child of <b>`*result`</b> the node will become, or
+ *		<b>`SAVL_EVEN`</b> if it is not to be moved.
  */
-struct savl_node *savl_last(struct savl_node *node)
+static int_fast8_t savl_rekey_search(struct savl_node *const node,
+				     const struct savl_node *const first,
+				     const struct savl_node *const last,
+				     const savl_cmpfn cmpfn,
+				     const union savl_key key,
+				     struct savl_node **const result)
 {
-	if (node == NULL)
-		return NULL;
+	struct savl_node *prev, *next, *hint;
 
-	while (node->right != NULL)
-		node = node->right;
+	prev = savl_prev(node);
+	next = savl_next(node);
 
-	return node;
+	if (prev != NULL && cmpfn(key, prev) <= 0) {
+		hint = prev;
+	}
+	else if (next != NULL && cmpfn(key, next) >= 0) {
+		hint = next;
+	}
+	else {
+		*result = NULL;
+		return SAVL_EVEN;	/* Order still holds */
+	}
+
+	return savl_search_hint(NULL, hint, first, last, cmpfn, key, result);
+}
+
+/**
+ * Reposition a node after its key has changed (if necessary).
+ *
+ * The new key is compared with the keys of the node's predecessor and
+ * successor.  If it is still between them, the node remains where it is, and
+ * the tree is not modified.  Otherwise, the node's new position is found by a
+ * search that starts at the neighbor in the direction that it moved (see
+ * savl_add_hint()), and the node is moved there.
+ *
+ * If another node already has the new key, the tree is not modified, and
+ * <b>`node`</b> remains in its old position.  The tree is then out of order,
+ * until the caller restores the node's old key (or removes the node with
+ * savl_remove_node(), which does not compare keys).
+ *
+ * The key in the structure that contains the node must be changed before this
+ * function is called.
+ *
+ * @param node		The node whose key has changed.
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed, <b>`*tree`</b> will be set to the
+ *			new root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The node's new key.
+ *
+ * @return	<b>`NULL`</b> if the node is in its correct position, or a
+ *		pointer to another node with an equal key (in which case
+ *		nothing has been changed).
+ */
+struct savl_node *savl_rekey(struct savl_node *const node,
+			     struct savl_node **const tree,
+			     const savl_cmpfn cmpfn, const union savl_key key)
+{
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	which_child = savl_rekey_search(node, NULL, NULL, cmpfn, key, &parent);
+	if (which_child == SAVL_EVEN)
+		return parent;	/* Not moved, or conflict */
+
+	savl_remove_node(node, tree);
+
+	/*
+	 * Nothing lies between parent and the new key, so the position is
+	 * still correct if rebalancing has left it empty.
+	 */
+	if ((which_child < 0 ? parent->left : parent->right) == NULL)
+		savl_link(tree, parent, which_child, node);
+	else
+		savl_add_hint(tree, parent, cmpfn, key, node);
+
+	return NULL;
+}
+
+/**
+ * Add a node to an augmented tree.  Otherwise identical to savl_add().
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added.
+ * @param replace	If the tree already contains a node with a key equal to
+ *			<b>`key`</b>, should the new node be inserted in its
+ *			place?
+ * @param aug		Augmentation callback.
+ *
+ * @return	<b>`NULL`</b> if the tree did not already contain a node with a
+ *		key equal to <b>`key`</b>, or a pointer to the pre-existing
+ *		node (which may have been replaced, depending on the value of
+ *		the <b>`replace`</b> parameter).
+ *
+ * @see	savl_aug
+ */
+struct savl_node *savl_aug_add(struct savl_node **const tree,
+			       const savl_cmpfn cmpfn,
+			       const union savl_key key,
+			       struct savl_node *const new,
+			       const _Bool replace,
+			       const struct savl_aug *const aug)
+{
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	which_child = savl_search(*tree, cmpfn, key, &parent);
+
+	if (which_child == SAVL_EVEN && parent != NULL && !replace)
+		return parent;
+
+	return savl_aug_link(tree, parent, which_child, new, aug);
+}
+
+/**
+ * Remove a node from an augmented tree.  Otherwise identical to
+ * savl_remove_node().
+ *
+ * @param node		The node to be deleted.
+ * @param[out] tree	A double pointer to the root node of the tree.
+ * @param aug		Augmentation callback.
+ *
+ * @see	savl_aug
+ */
+void savl_aug_remove_node(struct savl_node *const node,
+			  struct savl_node **const tree,
+			  const struct savl_aug *const aug)
+{
+	savl_remove_aug(node, tree, aug, SAVL_EVEN, NULL);
+}
+
+/**
+ * Remove a key from an augmented tree.  Otherwise identical to
+ * savl_remove().
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param aug		Augmentation callback.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree did not
+ *		contain a matching node.
+ *
+ * @see	savl_aug
+ */
+struct savl_node *savl_aug_remove(struct savl_node **const tree,
+				  const savl_cmpfn cmpfn,
+				  const union savl_key key,
+				  const struct savl_aug *const aug)
+{
+	struct savl_node *node;
+
+	if (savl_search(*tree, cmpfn, key, &node) != SAVL_EVEN || node == NULL)
+		return NULL;
+
+	savl_remove_aug(node, tree, aug, SAVL_EVEN, NULL);
+
+	return node;
+}
+
+/**
+ * Update the augmented data of a node, after the data from which it is
+ * computed (e.g. a value stored in the containing structure) has changed in
+ * place.  The node's ancestors are updated as needed.
+ *
+ * @param node	The node.
+ * @param aug	Augmentation callback.
+ *
+ * @see	savl_aug
+ */
+void savl_aug_update(struct savl_node *const node,
+		     const struct savl_aug *const aug)
+{
+	savl_aug_propagate(node, aug);
+}
+
+/**
+ * Remove a key from the tree.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed (because it is deleted or the tree
+ *			is rebalanced), <b>`*tree`</b> will be set to the new
+ *			root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree did not
+ *		contain a matching node.
+ */
+struct savl_node *savl_remove(struct savl_node **const tree,
+			      const savl_cmpfn cmpfn, const union savl_key key)
+{
+	struct savl_node *node;
+
+	if (savl_search(*tree, cmpfn, key, &node) != SAVL_EVEN || node == NULL)
+		return NULL;
+
+	savl_remove_node(node, tree);
+
+	return node;
+}
+
+/**
+ * Find the first node in a tree (or subtree).
+ *
+ * @param node	The tree (or subtree).
+ *
+ * @return	The first node in the (sub)tree.
+ */
+struct savl_node *savl_first(struct savl_node *node)
+{
+	if (node == NULL)
+		return NULL;
+
+	while (node->left != NULL)
+		node = node->left;
+
+	return node;
+}
+
+/**
+ * Find the last node in a tree (or subtree).
+ *
+ * @param node	The tree (or subtree).
+ *
+ * @return	The last node in the (sub)tree.
+ */
+struct savl_node *savl_last(struct savl_node *node)
+{
+	if (node == NULL)
+		return NULL;
+
+	while (node->right != NULL)
+		node = node->right;
+
+	return node;
 }
 
 /**
@@ -1003,9 +2105,9 @@ struct savl_node *savl_next(struct savl_node *node)
 	}
 
 	while (savl_which_child(node) == SAVL_RIGHT)
-		node = node->parent;
+		node = savl_parent(node);
 
-	return node->parent;
+	return savl_parent(node);
 }
 
 /**
@@ -1025,49 +2127,4404 @@ struct savl_node *savl_prev(struct savl_node *node)
 	}
 
 	while (savl_which_child(node) == SAVL_LEFT)
-		node = node->parent;
+		node = savl_parent(node);
 
-	return node->parent;
+	return savl_parent(node);
+}
+
+/*
+ * Defines two static functions that move a stack-based iterator, whose type is
+ * iter_t, through a tree of nodes of type node_t.  (struct savl_iter and
+ * struct savl_pf_cursor differ only in the type of node whose path they
+ * record, and the traversal of the two kinds of tree is identical.)
+ *
+ * prefix##_descend(it, node, dir) pushes node and its chain of left (dir < 0)
+ * or right (dir > 0) descendants onto the iterator's stack, and returns the
+ * node at the top of the stack (or NULL, if the stack is empty).
+ *
+ * prefix##_step(it, dir) moves the iterator to the next (dir > 0) or previous
+ * (dir < 0) node, like savl_next() and savl_prev(), but moves up the tree by
+ * popping the stack, rather than by following parent pointers.  It returns the
+ * new current node (or NULL).
+ */
+#define SAVL_PATH_FUNCS(prefix, iter_t, node_t)				\
+									\
+static node_t *prefix##_descend(iter_t *const it, node_t *node,		\
+				const int_fast8_t dir)			\
+{									\
+	while (node != NULL) {						\
+		assert(it->depth < SAVL_MAX_DEPTH);			\
+		it->path[it->depth++] = node;				\
+		node = dir < 0 ? node->left : node->right;		\
+	}								\
+									\
+	return it->depth > 0 ? it->path[it->depth - 1] : NULL;		\
+}									\
+									\
+static node_t *prefix##_step(iter_t *const it, const int_fast8_t dir)	\
+{									\
+	node_t *node, *child;						\
+									\
+	if (it->depth == 0)						\
+		return NULL;						\
+									\
+	node = it->path[it->depth - 1];					\
+	child = dir > 0 ? node->right : node->left;			\
+									\
+	if (child != NULL)						\
+		return prefix##_descend(it, child, -dir);		\
+									\
+	/* Move up until we move up from a child on the other side */	\
+	while (--it->depth > 0) {					\
+		child = node;						\
+		node = it->path[it->depth - 1];				\
+		if ((dir > 0 ? node->left : node->right) == child)	\
+			return node;					\
+	}								\
+									\
+	return NULL;							\
 }
 
+/* savl_iter_descend() and savl_iter_step() */
+SAVL_PATH_FUNCS(savl_iter, struct savl_iter, struct savl_node)
+
 /**
- * Free all of the nodes in a tree.
+ * Position an iterator at the first node in a tree.
  *
- * @param[in,out] tree	A double pointer to the root node of the tree.
- *			<b>`*tree`</b> is set to <b>`NULL`</b>.
- * @param freefn	A callback function to free the data structure that
- *			contains a node (and any associated resources).
+ * @param[out] it	The iterator.
+ * @param tree		The root of the tree.
+ *
+ * @return	The first node in the tree (or <b>`NULL`</b> if the tree is
+ *		empty).
+ *
+ * @see	savl_iter
  */
-void savl_free(struct savl_node **const tree, const savl_freefn freefn)
+struct savl_node *savl_iter_first(struct savl_iter *const it,
+				  struct savl_node *const tree)
 {
-	struct savl_node *node, *next;
+	it->depth = 0;
+	return savl_iter_descend(it, tree, SAVL_LEFT);
+}
 
-	node = savl_first(*tree);
+/**
+ * Position an iterator at the last node in a tree.
+ *
+ * @param[out] it	The iterator.
+ * @param tree		The root of the tree.
+ *
+ * @return	The last node in the tree (or <b>`NULL`</b> if the tree is
+ *		empty).
+ *
+ * @see	savl_iter
+ */
+struct savl_node *savl_iter_last(struct savl_iter *const it,
+				 struct savl_node *const tree)
+{
+	it->depth = 0;
+	return savl_iter_descend(it, tree, SAVL_RIGHT);
+}
+
+/**
+ * Position an iterator at the first node in a tree whose key is greater than
+ * or equal to a key.
+ *
+ * @param[out] it	The iterator.
+ * @param tree		The root of the tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The node (or <b>`NULL`</b> if every node in the tree has a
+ *		lower key).
+ *
+ * @see	savl_iter
+ * @see	savl_lower_bound
+ */
+struct savl_node *savl_iter_seek(struct savl_iter *const it,
+				 struct savl_node *const tree,
+				 const savl_cmpfn cmpfn,
+				 const union savl_key key)
+{
+	struct savl_node *node;
+	unsigned int found;
+	int cmp_result;
+
+	it->depth = 0;
+	found = 0;
+	node = tree;
 
 	while (node != NULL) {
 
-		if (node->left != NULL) {
+		assert(it->depth < SAVL_MAX_DEPTH);
+		it->path[it->depth++] = node;
+
+		cmp_result = cmpfn(key, node);
+
+		if (cmp_result <= 0) {
+			/* Candidate; look for a lower one */
+			found = it->depth;
+			if (cmp_result == 0)
+				break;
 			node = node->left;
-			continue;
 		}
-
-		if (node->right != NULL) {
+		else {
 			node = node->right;
-			continue;
 		}
+	}
 
+	/* The path to the candidate is a prefix of the search path */
+	it->depth = found;
 
-		switch (savl_which_child(node)) {
-			case SAVL_LEFT:		node->parent->left = NULL;
-						break;
-			case SAVL_RIGHT:	node->parent->right = NULL;
-						break;
-			case SAVL_EVEN:		*tree = NULL;
-						break;
-		}
+	return found > 0 ? it->path[found - 1] : NULL;
+}
 
-		next = node->parent;
-		freefn(node);
-		node = next;
+/**
+ * Move an iterator to the next node in its tree.
+ *
+ * @param it	The iterator.
+ *
+ * @return	The next node (or <b>`NULL`</b> if the iterator's current node
+ *		was the last node in the tree).
+ *
+ * @see	savl_iter
+ */
+struct savl_node *savl_iter_next(struct savl_iter *const it)
+{
+	return savl_iter_step(it, SAVL_RIGHT);
+}
+
+/**
+ * Move an iterator to the previous node in its tree.
+ *
+ * @param it	The iterator.
+ *
+ * @return	The previous node (or <b>`NULL`</b> if the iterator's current
+ *		node was the first node in the tree).
+ *
+ * @see	savl_iter
+ */
+struct savl_node *savl_iter_prev(struct savl_iter *const it)
+{
+	return savl_iter_step(it, SAVL_LEFT);
+}
+
+/**
+ * Fetch a batch of nodes from an iterator.
+ *
+ * Stores the iterator's current node and the nodes that follow it (up to
+ * <b>`count`</b> nodes in total) in <b>`out`</b>, and moves the iterator to
+ * the node after the last one stored.  For example:
+ *
+ *	struct savl_node *batch[64];
+ *	struct savl_iter it;
+ *	size_t i, n;
+ *
+ *	savl_iter_first(&it, tree);
+ *
+ *	while ((n = savl_iter_next_n(&it, batch, 64)) > 0) {
+ *		for (i = 0; i < n; ++i)
+ *			process(batch[i]);
+ *	}
+ *
+ * @param it		The iterator.
+ * @param[out] out	Array used to return the nodes.
+ * @param count		The size of <b>`out`</b>.
+ *
+ * @return	The number of nodes stored in <b>`out`</b>, which is less than
+ *		<b>`count`</b> only if the end of the tree was reached.
+ *
+ * @see	savl_iter
+ */
+size_t savl_iter_next_n(struct savl_iter *const it,
+			struct savl_node **const out, const size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count && it->depth > 0; ++i) {
+		out[i] = it->path[it->depth - 1];
+		savl_iter_step(it, SAVL_RIGHT);
 	}
+
+	return i;
+}
+
+/**
+ * Get a pointer to a key described by a key descriptor.
+ *
+ * @param node		The node.
+ * @param offset	The offset of the key from the node.
+ *
+ * @return	A pointer to the key.
+ */
+static inline const void *savl_kfield(const struct savl_node *const node,
+				      const ptrdiff_t offset)
+{
+	return (const unsigned char *)node + offset;
+}
+
+/*
+ * Search loop used by savl_ksearch().  cmp_expr is evaluated at every level of
+ * the tree, so the switch on the key type happens only once per search.
+ */
+#define SAVL_KSEARCH_LOOP(cmp_expr)					\
+	do {								\
+		while (1) {						\
+			cmp_result = (cmp_expr);			\
+									\
+			if (cmp_result < 0 && node->left != NULL) {	\
+				node = node->left;			\
+				continue;				\
+			}						\
+									\
+			if (cmp_result > 0 && node->right != NULL) {	\
+				node = node->right;			\
+				continue;				\
+			}						\
+									\
+			break;						\
+		}							\
+	} while (0)
+
+/* Compares k with the number of type t at node's key offset */
+#define SAVL_KCMP_NUM(t, k)						\
+	(((k) > *(const t *)savl_kfield(node, desc->offset))		\
+		- ((k) < *(const t *)savl_kfield(node, desc->offset)))
+
+/**
+ * Search a tree for a key that is described by a key descriptor.
+ *
+ * Works exactly like savl_search(), except that keys are compared directly,
+ * rather than by calling a comparison function.
+ *
+ * @param node		The root of the tree to be searched.
+ * @param desc		The key descriptor.
+ * @param key		The key.
+ * @param[out] result	Output parameter used to return the key's node (or its
+ *			prospective parent).
+ *
+ * @return	An integer value that indicates whether the new entry will be
+ *		the left child of the parent (<b>`SAVL_LEFT`</b>), the right
+ *		child of the parent (<b>`SAVL_RIGHT`</b>), or a replacement for
+ *		the parent (<b>`SAVL_EVEN`</b>).
+ *
+ * @see	savl_search
+ */
+static int_fast8_t savl_ksearch(struct savl_node *node,
+				const struct savl_keydesc *const desc,
+				const union savl_key key,
+				struct savl_node **const result)
+{
+	int cmp_result = 0;
+
+	if (node != NULL) {
+
+		switch (desc->type) {
+
+			case SAVL_KEY_INT32: {
+				const int32_t k = key.i;
+				SAVL_KSEARCH_LOOP(SAVL_KCMP_NUM(int32_t, k));
+				break;
+			}
+
+			case SAVL_KEY_UINT32: {
+				const uint32_t k = key.u;
+				SAVL_KSEARCH_LOOP(SAVL_KCMP_NUM(uint32_t, k));
+				break;
+			}
+
+			case SAVL_KEY_INT64: {
+				const int64_t k = *(const int64_t *)key.p;
+				SAVL_KSEARCH_LOOP(SAVL_KCMP_NUM(int64_t, k));
+				break;
+			}
+
+			case SAVL_KEY_UINT64: {
+				const uint64_t k = *(const uint64_t *)key.p;
+				SAVL_KSEARCH_LOOP(SAVL_KCMP_NUM(uint64_t, k));
+				break;
+			}
+
+			case SAVL_KEY_DOUBLE: {
+				const double k = *(const double *)key.p;
+				/* NaN compares equal to everything */
+				assert(k == k);
+				SAVL_KSEARCH_LOOP(SAVL_KCMP_NUM(double, k));
+				break;
+			}
+
+			case SAVL_KEY_BYTES:
+				SAVL_KSEARCH_LOOP(memcmp(key.p,
+						savl_kfield(node, desc->offset),
+						desc->len));
+				break;
+
+			default:
+				/* Not a valid enum savl_keytype value */
+				abort();
+		}
+	}
+
+	*result = node;
+
+	/* Return only the sign of the result, i.e. -1, 0, or 1 */
+	return (cmp_result > 0) - (cmp_result < 0);
+}
+
+/**
+ * Find a node in a tree, using a key descriptor.
+ *
+ * @param tree		The root of the tree to be searched.
+ * @param desc		The key descriptor.
+ * @param key		The key.
+ *
+ * @return	The node the corresponds to the key (if any), or <b>`NULL`</b>.
+ *
+ * @see	savl_keydesc
+ */
+struct savl_node *savl_kget(struct savl_node *const tree,
+			    const struct savl_keydesc *const desc,
+			    const union savl_key key)
+{
+	struct savl_node *node;
+
+	if (savl_ksearch(tree, desc, key, &node) == SAVL_EVEN)
+		return node;
+
+	return NULL;
+}
+
+/**
+ * Add a node to a tree, using a key descriptor.  Otherwise identical to
+ * savl_add().
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing, replacement of the root
+ *			node, or addition to an empty tree), <b>`*tree`</b> will
+ *			be changed to point to the new root node.
+ * @param desc		The key descriptor.
+ * @param key		The key.
+ * @param new		The node to be added.  It's key must compare equal to
+ *			<b>`key`</b>.
+ * @param replace	If the tree already contains a node with a key equal to
+ *			<b>`key`</b>, should the new node be inserted in its
+ *			place?
+ *
+ * @return	<b>`NULL`</b> if the tree did not already contain a node with a
+ *		key equal to <b>`key`</b>, or a pointer to the pre-existing
+ *		key (which may have been replaced, depending on the value of
+ *		the <b>`replace`</b> parameter).
+ *
+ * @see	savl_keydesc
+ */
+struct savl_node *savl_kadd(struct savl_node **const tree,
+			    const struct savl_keydesc *const desc,
+			    const union savl_key key,
+			    struct savl_node *const new, const _Bool replace)
+{
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	which_child = savl_ksearch(*tree, desc, key, &parent);
+
+	if (which_child == SAVL_EVEN && parent != NULL && !replace)
+		return parent;
+
+	return savl_link(tree, parent, which_child, new);
+}
+
+/**
+ * Remove a key from the tree, using a key descriptor.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed (because it is deleted or the tree
+ *			is rebalanced), <b>`*tree`</b> will be set to the new
+ *			root node.
+ * @param desc		The key descriptor.
+ * @param key		The key.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree did not
+ *		contain a matching node.
+ *
+ * @see	savl_keydesc
+ */
+struct savl_node *savl_kremove(struct savl_node **const tree,
+			       const struct savl_keydesc *const desc,
+			       const union savl_key key)
+{
+	struct savl_node *node;
+
+	if (savl_ksearch(*tree, desc, key, &node) != SAVL_EVEN || node == NULL)
+		return NULL;
+
+	savl_remove_node(node, tree);
+
+	return node;
+}
+
+/**
+ * Calculate the depth of a tree (or subtree).
+ *
+ * @param node	The root of the tree.
+ *
+ * @return	The depth of the tree (0 if the tree is empty).
+ */
+static int savl_height(const struct savl_node *node)
+{
+	int height = 0;
+
+	/* Follow the deeper child subtree at each level */
+	while (node != NULL) {
+		++height;
+		node = savl_skew(node) < SAVL_EVEN ? node->left : node->right;
+	}
+
+	return height;
+}
+
+/**
+ * Join two trees, using a pivot node.
+ *
+ * All of the keys in the left tree must be less than the key of the pivot,
+ * which must be less than all of the keys in the right tree.
+ *
+ * The pivot node is linked into the deeper tree at a point where the other tree
+ * can become its child without unbalancing it, and the tree is rebalanced from
+ * that point upward.  The cost is proportional to the difference between the
+ * depths of the trees.
+ *
+ * @param left		The root of the left tree.  (May be <b>`NULL`</b>.)
+ * @param left_h	The depth of the left tree.
+ * @param pivot		The pivot node.
+ * @param right		The root of the right tree.  (May be <b>`NULL`</b>.)
+ * @param right_h	The depth of the right tree.
+ * @param[out] height	Output parameter used to return the depth of the joined
+ *			tree.
+ *
+ * @return	The root of the joined tree.
+ */
+static struct savl_node *savl_join_depth(struct savl_node *const left,
+					 const int left_h,
+					 struct savl_node *const pivot,
+					 struct savl_node *const right,
+					 const int right_h, int *const height)
+{
+	struct savl_node *tree, *parent, *child;
+	int child_h;
+
+	if (left_h > right_h + 1) {
+
+		/* Find a subtree on left's right edge that right can join */
+		tree = left;
+		child = left;
+		child_h = left_h;
+		do {
+			parent = child;
+			child_h = savl_rdepth_of_right(child, child_h);
+			child = child->right;
+		} while (child_h > right_h + 1);
+
+		pivot->left = child;
+		pivot->right = right;
+		savl_set_skew(pivot, right_h - child_h);
+		savl_set_parent(pivot, parent);
+		parent->right = pivot;
+		if (child != NULL)
+			savl_set_parent(child, pivot);
+		if (right != NULL)
+			savl_set_parent(right, pivot);
+
+		/* Pivot's subtree is 1 deeper than the one that it replaced */
+		*height = left_h + savl_add_rebalance(parent, SAVL_RIGHT, &tree,
+						      NULL);
+		return tree;
+	}
+
+	if (right_h > left_h + 1) {
+
+		/* Find a subtree on right's left edge that left can join */
+		tree = right;
+		child = right;
+		child_h = right_h;
+		do {
+			parent = child;
+			child_h = savl_rdepth_of_left(child, child_h);
+			child = child->left;
+		} while (child_h > left_h + 1);
+
+		pivot->left = left;
+		pivot->right = child;
+		savl_set_skew(pivot, child_h - left_h);
+		savl_set_parent(pivot, parent);
+		parent->left = pivot;
+		if (left != NULL)
+			savl_set_parent(left, pivot);
+		if (child != NULL)
+			savl_set_parent(child, pivot);
+
+		*height = right_h + savl_add_rebalance(parent, SAVL_LEFT, &tree,
+						       NULL);
+		return tree;
+	}
+
+	/* Depths are within 1 of each other; pivot becomes the root */
+	savl_set_parent(pivot, NULL);
+	pivot->left = left;
+	pivot->right = right;
+	savl_set_skew(pivot, right_h - left_h);
+	if (left != NULL)
+		savl_set_parent(left, pivot);
+	if (right != NULL)
+		savl_set_parent(right, pivot);
+
+	*height = (left_h > right_h ? left_h : right_h) + 1;
+	return pivot;
+}
+
+/**
+ * Join two trees, without a pivot node.
+ *
+ * All of the keys in the left tree must be less than all of the keys in the
+ * right tree.  The last node of the left tree is removed and used as the
+ * pivot.
+ *
+ * @param left		The root of the left tree.  (May be <b>`NULL`</b>.)
+ * @param left_h	The depth of the left tree.
+ * @param right		The root of the right tree.  (May be <b>`NULL`</b>.)
+ * @param right_h	The depth of the right tree.
+ * @param[out] height	Output parameter used to return the depth of the joined
+ *			tree.
+ *
+ * @return	The root of the joined tree.
+ */
+static struct savl_node *savl_join2_depth(struct savl_node *left,
+					  const int left_h,
+					  struct savl_node *const right,
+					  const int right_h, int *const height)
+{
+	struct savl_node *pivot;
+
+	if (left == NULL) {
+		*height = right_h;
+		return right;
+	}
+
+	if (right == NULL) {
+		*height = left_h;
+		return left;
+	}
+
+	pivot = savl_last(left);
+	savl_remove_node(pivot, &left);
+
+	return savl_join_depth(left, savl_height(left), pivot, right, right_h,
+			       height);
+}
+
+/**
+ * Detach the root of a tree from its child subtrees.
+ *
+ * The root node is reinitialized, and the child subtrees become separate
+ * trees.
+ *
+ * @param node		The root of the tree.
+ * @param height	The depth of the tree.
+ * @param[out] left	Output parameter used to return the root's former left
+ *			subtree.
+ * @param[out] left_h	Output parameter used to return the depth of the left
+ *			subtree.
+ * @param[out] right	Output parameter used to return the root's former right
+ *			subtree.
+ * @param[out] right_h	Output parameter used to return the depth of the right
+ *			subtree.
+ */
+static void savl_detach_root(struct savl_node *const node, const int height,
+			     struct savl_node **const left, int *const left_h,
+			     struct savl_node **const right, int *const right_h)
+{
+	*left = node->left;
+	*left_h = savl_rdepth_of_left(node, height);
+	if (*left != NULL)
+		savl_set_parent(*left, NULL);
+
+	*right = node->right;
+	*right_h = savl_rdepth_of_right(node, height);
+	if (*right != NULL)
+		savl_set_parent(*right, NULL);
+
+	savl_set_parent(node, NULL);
+	node->left = NULL;
+	node->right = NULL;
+	savl_set_skew(node, SAVL_EVEN);
+}
+
+/**
+ * Split a tree into the nodes with keys less than a key and the nodes with
+ * keys greater than the key.
+ *
+ * The tree is taken apart along the search path for the key, and the pieces on
+ * either side of the path are joined back together from the bottom up.  The
+ * cost of the joins is proportional to the depth of the tree.
+ *
+ * @param node		The root of the tree to be split.
+ * @param height	The depth of the tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param[out] left	Output parameter used to return the tree of nodes with
+ *			keys less than <b>`key`</b>.
+ * @param[out] left_h	Output parameter used to return the depth of the left
+ *			tree.
+ * @param[out] right	Output parameter used to return the tree of nodes with
+ *			keys greater than <b>`key`</b>.
+ * @param[out] right_h	Output parameter used to return the depth of the right
+ *			tree.
+ *
+ * @return	The node with a key equal to <b>`key`</b> (if any), which is not
+ *		part of either output tree, or <b>`NULL`</b>.
+ */
+static struct savl_node *savl_split_depth(struct savl_node *const node,
+					  const int height,
+					  const savl_cmpfn cmpfn,
+					  const union savl_key key,
+					  struct savl_node **const left,
+					  int *const left_h,
+					  struct savl_node **const right,
+					  int *const right_h)
+{
+	struct savl_node *l, *r, *found;
+	int cmp_result, lh, rh;
+
+	if (node == NULL) {
+		*left = NULL;
+		*left_h = 0;
+		*right = NULL;
+		*right_h = 0;
+		return NULL;
+	}
+
+	cmp_result = cmpfn(key, node);
+
+	savl_detach_root(node, height, &l, &lh, &r, &rh);
+
+	if (cmp_result == 0) {
+		*left = l;
+		*left_h = lh;
+		*right = r;
+		*right_h = rh;
+		return node;
+	}
+
+	if (cmp_result < 0) {
+		/* Node and its right subtree belong to the right tree */
+		found = savl_split_depth(l, lh, cmpfn, key,
+					 left, left_h, &l, &lh);
+		*right = savl_join_depth(l, lh, node, r, rh, right_h);
+	}
+	else {
+		/* Node and its left subtree belong to the left tree */
+		found = savl_split_depth(r, rh, cmpfn, key,
+					 &r, &rh, right, right_h);
+		*left = savl_join_depth(l, lh, node, r, rh, left_h);
+	}
+
+	return found;
+}
+
+/**
+ * Join two trees.
+ *
+ * All of the keys in the left tree must be less than the key of the pivot
+ * node (if any), which must be less than all of the keys in the right tree.
+ * The cost is proportional to the logarithm of the number of nodes in the
+ * trees.
+ *
+ * @param left		The root of the left tree.  (May be <b>`NULL`</b>.)
+ * @param pivot		A node that is not part of either tree, which will be
+ *			added to the joined tree, or <b>`NULL`</b>.
+ * @param right		The root of the right tree.  (May be <b>`NULL`</b>.)
+ *
+ * @return	The root of the joined tree.
+ */
+struct savl_node *savl_join(struct savl_node *const left,
+			    struct savl_node *const pivot,
+			    struct savl_node *const right)
+{
+	int height;
+
+	if (pivot == NULL) {
+		return savl_join2_depth(left, savl_height(left),
+					right, savl_height(right), &height);
+	}
+
+	return savl_join_depth(left, savl_height(left), pivot,
+			       right, savl_height(right), &height);
+}
+
+/**
+ * Split a tree into two trees.
+ *
+ * The nodes with keys less than <b>`key`</b> are moved to one tree, and the
+ * nodes with keys greater than <b>`key`</b> are moved to the other.  The node
+ * with a key equal to <b>`key`</b> (if any) is removed from the tree.  The cost
+ * is proportional to the logarithm of the number of nodes in the tree.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree to be
+ *			split.  <b>`*tree`</b> is set to <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param[out] left	Output parameter used to return the tree of nodes with
+ *			keys less than <b>`key`</b>.
+ * @param[out] right	Output parameter used to return the tree of nodes with
+ *			keys greater than <b>`key`</b>.
+ *
+ * @return	The removed node with a key equal to <b>`key`</b> (if any), or
+ *		<b>`NULL`</b>.
+ */
+struct savl_node *savl_split(struct savl_node **const tree,
+			     const savl_cmpfn cmpfn, const union savl_key key,
+			     struct savl_node **const left,
+			     struct savl_node **const right)
+{
+	struct savl_node *found;
+	int left_h, right_h;
+
+	found = savl_split_depth(*tree, savl_height(*tree), cmpfn, key,
+				 left, &left_h, right, &right_h);
+	*tree = NULL;
+
+	return found;
+}
+
+/**
+ * Discard a tree that is not part of the result of a set operation.
+ *
+ * @param tree		The root of the tree.
+ * @param freefn	Callback function to free the tree's nodes, or
+ *			<b>`NULL`</b>.
+ */
+static void savl_discard(struct savl_node *tree, const savl_freefn freefn)
+{
+	if (freefn != NULL)
+		savl_free(&tree, freefn);
+}
+
+/**
+ * Discard a node that is not part of the result of a set operation.
+ *
+ * @param node		The node (or <b>`NULL`</b>).
+ * @param freefn	Callback function to free the node, or <b>`NULL`</b>.
+ */
+static void savl_discard_node(struct savl_node *const node,
+			      const savl_freefn freefn)
+{
+	if (node != NULL && freefn != NULL)
+		freefn(node);
+}
+
+/**
+ * Recursively compute the union of two trees.
+ *
+ * The first tree's root is used to split the second tree, the union is
+ * computed independently on each side of the root, and the two results are
+ * joined with the root as the pivot.
+ *
+ * @param t1		The root of the first tree.
+ * @param h1		The depth of the first tree.
+ * @param t2		The root of the second tree.
+ * @param h2		The depth of the second tree.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free nodes of the second tree
+ *			whose keys are also in the first tree, or
+ *			<b>`NULL`</b>.
+ * @param[out] height	Output parameter used to return the depth of the
+ *			resulting tree.
+ *
+ * @return	The root of the resulting tree.
+ */
+static struct savl_node *savl_union_depth(struct savl_node *const t1,
+					  const int h1,
+					  struct savl_node *const t2,
+					  const int h2,
+					  const savl_cmpfn cmpfn,
+					  const savl_keyfn keyfn,
+					  const savl_freefn freefn,
+					  int *const height)
+{
+	struct savl_node *l1, *r1, *l2, *r2, *dup;
+	int l1_h, r1_h, l2_h, r2_h;
+
+	if (t1 == NULL) {
+		*height = h2;
+		return t2;
+	}
+
+	if (t2 == NULL) {
+		*height = h1;
+		return t1;
+	}
+
+	savl_detach_root(t1, h1, &l1, &l1_h, &r1, &r1_h);
+	dup = savl_split_depth(t2, h2, cmpfn, keyfn(t1),
+			       &l2, &l2_h, &r2, &r2_h);
+	savl_discard_node(dup, freefn);
+
+	l1 = savl_union_depth(l1, l1_h, l2, l2_h, cmpfn, keyfn, freefn, &l1_h);
+	r1 = savl_union_depth(r1, r1_h, r2, r2_h, cmpfn, keyfn, freefn, &r1_h);
+
+	return savl_join_depth(l1, l1_h, t1, r1, r1_h, height);
+}
+
+/**
+ * Recursively compute the intersection of two trees.
+ *
+ * @param t1		The root of the first tree.
+ * @param h1		The depth of the first tree.
+ * @param t2		The root of the second tree.
+ * @param h2		The depth of the second tree.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free nodes that are not part of
+ *			the result, or <b>`NULL`</b>.
+ * @param[out] height	Output parameter used to return the depth of the
+ *			resulting tree.
+ *
+ * @return	The root of the resulting tree.
+ *
+ * @see	savl_union_depth
+ */
+static struct savl_node *savl_inter_depth(struct savl_node *const t1,
+					  const int h1,
+					  struct savl_node *const t2,
+					  const int h2,
+					  const savl_cmpfn cmpfn,
+					  const savl_keyfn keyfn,
+					  const savl_freefn freefn,
+					  int *const height)
+{
+	struct savl_node *l1, *r1, *l2, *r2, *dup;
+	int l1_h, r1_h, l2_h, r2_h;
+
+	if (t1 == NULL || t2 == NULL) {
+		savl_discard(t1, freefn);
+		savl_discard(t2, freefn);
+		*height = 0;
+		return NULL;
+	}
+
+	savl_detach_root(t1, h1, &l1, &l1_h, &r1, &r1_h);
+	dup = savl_split_depth(t2, h2, cmpfn, keyfn(t1),
+			       &l2, &l2_h, &r2, &r2_h);
+
+	l1 = savl_inter_depth(l1, l1_h, l2, l2_h, cmpfn, keyfn, freefn, &l1_h);
+	r1 = savl_inter_depth(r1, r1_h, r2, r2_h, cmpfn, keyfn, freefn, &r1_h);
+
+	if (dup != NULL) {
+		savl_discard_node(dup, freefn);
+		return savl_join_depth(l1, l1_h, t1, r1, r1_h, height);
+	}
+
+	savl_discard_node(t1, freefn);
+	return savl_join2_depth(l1, l1_h, r1, r1_h, height);
+}
+
+/**
+ * Recursively compute the difference of two trees.
+ *
+ * The second tree's root is used to split the first tree.
+ *
+ * @param t1		The root of the first tree.
+ * @param h1		The depth of the first tree.
+ * @param t2		The root of the second tree.
+ * @param h2		The depth of the second tree.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free nodes that are not part of
+ *			the result, or <b>`NULL`</b>.
+ * @param[out] height	Output parameter used to return the depth of the
+ *			resulting tree.
+ *
+ * @return	The root of the resulting tree.
+ *
+ * @see	savl_union_depth
+ */
+static struct savl_node *savl_diff_depth(struct savl_node *const t1,
+					 const int h1,
+					 struct savl_node *const t2,
+					 const int h2,
+					 const savl_cmpfn cmpfn,
+					 const savl_keyfn keyfn,
+					 const savl_freefn freefn,
+					 int *const height)
+{
+	struct savl_node *l1, *r1, *l2, *r2, *dup;
+	int l1_h, r1_h, l2_h, r2_h;
+
+	if (t1 == NULL || t2 == NULL) {
+		savl_discard(t2, freefn);
+		*height = h1;
+		return t1;
+	}
+
+	savl_detach_root(t2, h2, &l2, &l2_h, &r2, &r2_h);
+	dup = savl_split_depth(t1, h1, cmpfn, keyfn(t2),
+			       &l1, &l1_h, &r1, &r1_h);
+	savl_discard_node(dup, freefn);
+	savl_discard_node(t2, freefn);
+
+	l1 = savl_diff_depth(l1, l1_h, l2, l2_h, cmpfn, keyfn, freefn, &l1_h);
+	r1 = savl_diff_depth(r1, r1_h, r2, r2_h, cmpfn, keyfn, freefn, &r1_h);
+
+	return savl_join2_depth(l1, l1_h, r1, r1_h, height);
+}
+
+/**
+ * Merge one tree into another.
+ *
+ * After the merge, the first tree contains all of the nodes from both trees,
+ * except that nodes in the second tree whose keys are also in the first tree
+ * are discarded.  The cost is O(m log(n/m + 1)), where m and n are the sizes of
+ * the smaller and larger trees.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the first tree.
+ *			<b>`*tree`</b> is set to the root of the merged tree.
+ * @param[in,out] other	A double pointer to the root node of the second tree.
+ *			<b>`*other`</b> is set to <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.  It is called with keys of nodes
+ *			in the first tree and nodes of the second tree.
+ * @param keyfn		Key function.  It is called only with nodes of the
+ *			first tree.
+ * @param freefn	Callback function to free the discarded nodes, or
+ *			<b>`NULL`</b>.
+ */
+void savl_union(struct savl_node **const tree, struct savl_node **const other,
+		const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		const savl_freefn freefn)
+{
+	int height;
+
+	*tree = savl_union_depth(*tree, savl_height(*tree),
+				 *other, savl_height(*other),
+				 cmpfn, keyfn, freefn, &height);
+	*other = NULL;
+}
+
+/**
+ * Intersect one tree with another.
+ *
+ * After the operation, the first tree contains only those of its nodes whose
+ * keys are also in the second tree.  All other nodes from both trees (including
+ * all nodes from the second tree) are discarded.  The cost is
+ * O(m log(n/m + 1)), where m and n are the sizes of the smaller and larger
+ * trees, plus the cost of freeing the discarded nodes (if any).
+ *
+ * @param[in,out] tree	A double pointer to the root node of the first tree.
+ *			<b>`*tree`</b> is set to the root of the resulting
+ *			tree.
+ * @param[in,out] other	A double pointer to the root node of the second tree.
+ *			<b>`*other`</b> is set to <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.  It is called with keys of nodes
+ *			in the first tree and nodes of the second tree.
+ * @param keyfn		Key function.  It is called only with nodes of the
+ *			first tree.
+ * @param freefn	Callback function to free the discarded nodes, or
+ *			<b>`NULL`</b>.
+ */
+void savl_intersection(struct savl_node **const tree,
+		       struct savl_node **const other,
+		       const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		       const savl_freefn freefn)
+{
+	int height;
+
+	*tree = savl_inter_depth(*tree, savl_height(*tree),
+				 *other, savl_height(*other),
+				 cmpfn, keyfn, freefn, &height);
+	*other = NULL;
+}
+
+/**
+ * Remove the keys in one tree from another.
+ *
+ * After the operation, the first tree contains only those of its nodes whose
+ * keys are not in the second tree.  All other nodes from both trees (including
+ * all nodes from the second tree) are discarded.  The cost is
+ * O(m log(n/m + 1)), where m and n are the sizes of the smaller and larger
+ * trees, plus the cost of freeing the discarded nodes (if any).
+ *
+ * @param[in,out] tree	A double pointer to the root node of the first tree.
+ *			<b>`*tree`</b> is set to the root of the resulting
+ *			tree.
+ * @param[in,out] other	A double pointer to the root node of the second tree.
+ *			<b>`*other`</b> is set to <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.  It is called with keys of nodes
+ *			in the second tree and nodes of the first tree.
+ * @param keyfn		Key function.  It is called only with nodes of the
+ *			second tree.
+ * @param freefn	Callback function to free the discarded nodes, or
+ *			<b>`NULL`</b>.
+ */
+void savl_difference(struct savl_node **const tree,
+		     struct savl_node **const other,
+		     const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		     const savl_freefn freefn)
+{
+	int height;
+
+	*tree = savl_diff_depth(*tree, savl_height(*tree),
+				*other, savl_height(*other),
+				cmpfn, keyfn, freefn, &height);
+	*other = NULL;
+}
+
+/**
+ * Call a function for each node in a range of keys, in order.
+ *
+ * The callback function must not modify the tree.
+ *
+ * @param tree		The root of the tree.
+ * @param cmpfn		Comparison function.
+ * @param lo		The lowest key in the range (inclusive).
+ * @param hi		The highest key in the range (inclusive).
+ * @param visitfn	The callback function.
+ * @param arg		Argument passed to the callback function.
+ *
+ * @return	The first non-zero value returned by the callback function (which
+ *		stops the iteration), or zero.
+ */
+int savl_foreach_range(struct savl_node *const tree, const savl_cmpfn cmpfn,
+		       const union savl_key lo, const union savl_key hi,
+		       const savl_visitfn visitfn, void *const arg)
+{
+	struct savl_node *node;
+	int result;
+
+	node = savl_bound_above(tree, cmpfn, lo, 1);
+
+	while (node != NULL && cmpfn(hi, node) >= 0) {
+
+		result = visitfn(node, arg);
+		if (result != 0)
+			return result;
+
+		node = savl_next(node);
+	}
+
+	return 0;
+}
+
+/**
+ * Remove all of the nodes in a range of keys from a tree.
+ *
+ * The tree is split at both ends of the range, and the remaining trees are
+ * joined, so the cost of removal is independent of the number of nodes removed
+ * (other than the cost of freeing them).
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.
+ *			<b>`*tree`</b> is set to the new root node.
+ * @param cmpfn		Comparison function.
+ * @param lo		The lowest key in the range (inclusive).
+ * @param hi		The highest key in the range (inclusive).
+ * @param freefn	A callback function to free the data structures that
+ *			contain the removed nodes (and any associated
+ *			resources), or <b>`NULL`</b>.
+ *
+ * @return	If <b>`freefn`</b> is <b>`NULL`</b>, the root of a tree that
+ *		contains the removed nodes (or <b>`NULL`</b>, if no nodes were
+ *		removed).  The caller can walk this tree or pass it to
+ *		savl_free().  If <b>`freefn`</b> is not <b>`NULL`</b>, the
+ *		removed nodes have been freed, and the return value is
+ *		<b>`NULL`</b>.
+ */
+struct savl_node *savl_remove_range(struct savl_node **const tree,
+				    const savl_cmpfn cmpfn,
+				    const union savl_key lo,
+				    const union savl_key hi,
+				    const savl_freefn freefn)
+{
+	struct savl_node *left, *mid, *right, *lo_node, *hi_node;
+	int left_h, mid_h, right_h, height;
+
+	lo_node = savl_split_depth(*tree, savl_height(*tree), cmpfn, lo,
+				   &left, &left_h, &right, &right_h);
+
+	/* Empty range; put the tree back together */
+	if (lo_node != NULL && cmpfn(hi, lo_node) < 0) {
+		*tree = savl_join_depth(left, left_h, lo_node, right, right_h,
+					&height);
+		return NULL;
+	}
+
+	hi_node = savl_split_depth(right, right_h, cmpfn, hi,
+				   &mid, &mid_h, &right, &right_h);
+
+	*tree = savl_join2_depth(left, left_h, right, right_h, &height);
+
+	/* Gather the removed nodes into a single tree */
+	if (lo_node != NULL)
+		mid = savl_join_depth(NULL, 0, lo_node, mid, mid_h, &mid_h);
+
+	if (hi_node != NULL)
+		mid = savl_join_depth(mid, mid_h, hi_node, NULL, 0, &mid_h);
+
+	if (freefn != NULL)
+		savl_free(&mid, freefn);
+
+	return mid;
+}
+
+/**
+ * Free all of the nodes in a tree.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.
+ *			<b>`*tree`</b> is set to <b>`NULL`</b>.
+ * @param freefn	A callback function to free the data structure that
+ *			contains a node (and any associated resources).
+ */
+void savl_free(struct savl_node **const tree, const savl_freefn freefn)
+{
+	struct savl_node *node, *next;
+
+	node = savl_first(*tree);
+
+	while (node != NULL) {
+
+		if (node->left != NULL) {
+			node = node->left;
+			continue;
+		}
+
+		if (node->right != NULL) {
+			node = node->right;
+			continue;
+		}
+
+
+		switch (savl_which_child(node)) {
+			case SAVL_LEFT:		savl_parent(node)->left = NULL;
+						break;
+			case SAVL_RIGHT:	savl_parent(node)->right = NULL;
+						break;
+			case SAVL_EVEN:		*tree = NULL;
+						break;
+		}
+
+		next = savl_parent(node);
+		freefn(node);
+		node = next;
+	}
+}
+
+/*
+ *
+ * Tree handles
+ *
+ */
+
+/**
+ * Link a node into a tree with a handle at a known position.  Otherwise
+ * identical to savl_link().
+ *
+ * @param tree		The tree.
+ * @param parent	The new node's parent (or the node that it will replace,
+ *			if <b>`dir`</b> is zero).
+ * @param dir		Which child of <b>`parent`</b> the new node will become
+ *			(or zero to replace <b>`parent`</b>).
+ * @param new		The node to be linked into the tree.
+ *
+ * @return	The node that was replaced (if <b>`dir`</b> is zero), or
+ *		<b>`NULL`</b>.
+ *
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_link(struct savl_tree *const tree,
+				 struct savl_node *const parent, const int dir,
+				 struct savl_node *const new)
+{
+	struct savl_node *old;
+
+	old = savl_aug_link(&tree->root, parent, dir, new, NULL);
+
+	if (dir == 0 && parent != NULL) {
+		/* Replaced parent */
+		if (tree->first == old)
+			tree->first = new;
+		if (tree->last == old)
+			tree->last = new;
+		return old;
+	}
+
+	if (tree->count++ == 0) {
+		tree->first = new;
+		tree->last = new;
+	}
+	else if (dir < 0 && parent == tree->first) {
+		tree->first = new;
+	}
+	else if (dir > 0 && parent == tree->last) {
+		tree->last = new;
+	}
+
+	return NULL;
+}
+
+/**
+ * Add a node to a tree with a handle.  Otherwise identical to savl_add().
+ *
+ * @param tree		The tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added.  It's key must compare equal to
+ *			<b>`key`</b>.
+ * @param replace	If the tree already contains a node with a key equal to
+ *			<b>`key`</b>, should the new node be inserted in its
+ *			place?
+ *
+ * @return	<b>`NULL`</b> if the tree did not already contain a node with a
+ *		key equal to <b>`key`</b>, or a pointer to the pre-existing
+ *		node (which may have been replaced, depending on the value of
+ *		the <b>`replace`</b> parameter).
+ *
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_add(struct savl_tree *const tree,
+				const savl_cmpfn cmpfn,
+				const union savl_key key,
+				struct savl_node *const new,
+				const _Bool replace)
+{
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	which_child = savl_search(tree->root, cmpfn, key, &parent);
+
+	if (which_child == SAVL_EVEN && parent != NULL && !replace)
+		return parent;
+
+	return savl_tree_link(tree, parent, which_child, new);
+}
+
+/**
+ * Add a node to a tree with a handle, starting the search at a "hint" node.
+ * Otherwise identical to savl_add_hint().
+ *
+ * The climb from the hint stops at the handle's first or last node, so adding
+ * a new largest key with savl_tree_last() as the hint (or a new smallest key
+ * with savl_tree_first()) requires one comparison and no search.
+ *
+ * @param tree		The tree.
+ * @param hint		A node in the tree whose key is close to <b>`key`</b>,
+ *			or <b>`NULL`</b> (to search from the root).
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added.  It's key must compare equal to
+ *			<b>`key`</b>.
+ *
+ * @return	<b>`NULL`</b> if the node was added, or a pointer to the
+ *		pre-existing node with an equal key.
+ *
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_add_hint(struct savl_tree *const tree,
+				     struct savl_node *const hint,
+				     const savl_cmpfn cmpfn,
+				     const union savl_key key,
+				     struct savl_node *const new)
+{
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	which_child = savl_search_hint(tree->root, hint, tree->first,
+				       tree->last, cmpfn, key, &parent);
+
+	if (which_child == SAVL_EVEN && parent != NULL)
+		return parent;
+
+	return savl_tree_link(tree, parent, which_child, new);
+}
+
+/**
+ * Search a tree with a handle for a key, and record the position at which a
+ * node with the key would be added.  Otherwise identical to savl_locate().
+ *
+ * savl_link_at() updates the handle when it links a node at the insertion
+ * point.
+ *
+ * @param tree		The tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param[out] point	Output parameter used to return the insertion point.
+ *
+ * @return	The node with a matching key (or <b>`NULL`</b> if the tree does
+ *		not contain a matching node).
+ *
+ * @see	savl_locate
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_locate(struct savl_tree *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key,
+				   struct savl_point *const point)
+{
+	struct savl_node *const existing =
+		savl_locate(&tree->root, cmpfn, key, point);
+
+	point->handle = tree;
+
+	return existing;
+}
+
+/**
+ * Find the node with a key in a tree with a handle, or create and add one.
+ * Otherwise identical to savl_find_or_insert().
+ *
+ * @param tree		The tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param ctor		Constructor callback, which is called to create the new
+ *			node.  Its key must compare equal to <b>`key`</b>.
+ * @param ctx		Context argument passed to <b>`ctor`</b>.
+ *
+ * @return	The existing node, the new node, or <b>`NULL`</b> (if
+ *		<b>`ctor`</b> returned <b>`NULL`</b>).
+ *
+ * @see	savl_find_or_insert
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_find_or_insert(struct savl_tree *const tree,
+					   const savl_cmpfn cmpfn,
+					   const union savl_key key,
+					   const savl_ctorfn ctor,
+					   void *const ctx)
+{
+	struct savl_node *parent, *new;
+	int_fast8_t which_child;
+
+	which_child = savl_search(tree->root, cmpfn, key, &parent);
+
+	if (which_child == SAVL_EVEN && parent != NULL)
+		return parent;
+
+	new = ctor(key, ctx);
+	if (new != NULL)
+		savl_tree_link(tree, parent, which_child, new);
+
+	return new;
+}
+
+/**
+ * Remove a node from a tree with a handle.
+ *
+ * @param tree	The tree.
+ * @param node	The node to be deleted.
+ *
+ * @see	savl_tree
+ */
+void savl_tree_remove_node(struct savl_tree *const tree,
+			   struct savl_node *const node)
+{
+	/* first has no left child and last has no right child, so O(1) */
+	if (node == tree->first)
+		tree->first = savl_next(node);
+	if (node == tree->last)
+		tree->last = savl_prev(node);
+
+	savl_remove_aug(node, &tree->root, NULL, SAVL_EVEN, &tree->which_repl);
+	--tree->count;
+}
+
+/**
+ * Remove a node from a tree with a handle, and return the node that followed
+ * it.  Otherwise identical to savl_remove_node_next().
+ *
+ * @param tree	The tree.
+ * @param node	The node to be deleted.
+ *
+ * @return	The node that followed the deleted node (or <b>`NULL`</b> if
+ *		the deleted node was the last node in the tree).
+ *
+ * @see	savl_remove_node_next
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_remove_node_next(struct savl_tree *const tree,
+					     struct savl_node *const node)
+{
+	struct savl_node *next;
+
+	/* A node with 2 children is neither the first nor the last node */
+	if (node->left != NULL && node->right != NULL) {
+		--tree->count;
+		return savl_remove_aug(node, &tree->root, NULL, SAVL_RIGHT,
+				       NULL);
+	}
+
+	next = savl_next(node);
+	savl_tree_remove_node(tree, node);
+
+	return next;
+}
+
+/**
+ * Remove a node from a tree with a handle, and return the node that preceded
+ * it.  Otherwise identical to savl_remove_node_prev().
+ *
+ * @param tree	The tree.
+ * @param node	The node to be deleted.
+ *
+ * @return	The node that preceded the deleted node (or <b>`NULL`</b> if
+ *		the deleted node was the first node in the tree).
+ *
+ * @see	savl_remove_node_prev
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_remove_node_prev(struct savl_tree *const tree,
+					     struct savl_node *const node)
+{
+	struct savl_node *prev;
+
+	if (node->left != NULL && node->right != NULL) {
+		--tree->count;
+		return savl_remove_aug(node, &tree->root, NULL, SAVL_LEFT,
+				       NULL);
+	}
+
+	prev = savl_prev(node);
+	savl_tree_remove_node(tree, node);
+
+	return prev;
+}
+
+/**
+ * Reposition a node in a tree with a handle after its key has changed (if
+ * necessary).  Otherwise identical to savl_rekey().
+ *
+ * The search for the node's new position stops at the handle's first or last
+ * node, so moving a node to either end of the tree requires no search.
+ *
+ * @param tree	The tree.
+ * @param node	The node whose key has changed.
+ * @param cmpfn	Comparison function.
+ * @param key	The node's new key.
+ *
+ * @return	<b>`NULL`</b> if the node is in its correct position, or a
+ *		pointer to another node with an equal key (in which case
+ *		nothing has been changed).
+ *
+ * @see	savl_rekey
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_rekey(struct savl_tree *const tree,
+				  struct savl_node *const node,
+				  const savl_cmpfn cmpfn,
+				  const union savl_key key)
+{
+	struct savl_node *parent;
+	int_fast8_t which_child;
+
+	which_child = savl_rekey_search(node, tree->first, tree->last,
+					cmpfn, key, &parent);
+	if (which_child == SAVL_EVEN)
+		return parent;
+
+	savl_tree_remove_node(tree, node);
+
+	if ((which_child < 0 ? parent->left : parent->right) == NULL)
+		savl_tree_link(tree, parent, which_child, node);
+	else
+		savl_tree_add_hint(tree, parent, cmpfn, key, node);
+
+	return NULL;
+}
+
+/**
+ * Remove a key from a tree with a handle.
+ *
+ * @param tree	The tree.
+ * @param cmpfn	Comparison function.
+ * @param key	The key.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree did not
+ *		contain a matching node.
+ *
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_remove(struct savl_tree *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key)
+{
+	struct savl_node *node;
+
+	if (savl_search(tree->root, cmpfn, key, &node) != SAVL_EVEN
+							|| node == NULL) {
+		return NULL;
+	}
+
+	savl_tree_remove_node(tree, node);
+
+	return node;
+}
+
+/**
+ * Remove the first (lowest key) node from a tree with a handle.
+ *
+ * @param tree	The tree.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree is
+ *		empty).
+ *
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_pop_first(struct savl_tree *const tree)
+{
+	struct savl_node *const node = tree->first;
+
+	if (node != NULL)
+		savl_tree_remove_node(tree, node);
+
+	return node;
+}
+
+/**
+ * Remove the last (highest key) node from a tree with a handle.
+ *
+ * @param tree	The tree.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree is
+ *		empty).
+ *
+ * @see	savl_tree
+ */
+struct savl_node *savl_tree_pop_last(struct savl_tree *const tree)
+{
+	struct savl_node *const node = tree->last;
+
+	if (node != NULL)
+		savl_tree_remove_node(tree, node);
+
+	return node;
+}
+
+/**
+ * Free all of the nodes in a tree with a handle, and reset the handle.
+ *
+ * @param tree		The tree.
+ * @param freefn	A callback function to free the data structure that
+ *			contains a node (and any associated resources).
+ *
+ * @see	savl_free
+ * @see	savl_tree
+ */
+void savl_tree_free(struct savl_tree *const tree, const savl_freefn freefn)
+{
+	savl_free(&tree->root, freefn);
+
+	tree->count = 0;
+	tree->first = NULL;
+	tree->last = NULL;
+}
+
+/*
+ *
+ * Order statistics
+ *
+ */
+
+/**
+ * Get the size of a subtree of {@link savl_snode} structures.
+ *
+ * @param node	The root of the subtree (or <b>`NULL`</b>).
+ *
+ * @return	The number of nodes in the subtree.
+ */
+static inline size_t savl_size_of(const struct savl_node *const node)
+{
+	if (node == NULL)
+		return 0;
+
+	return SAVL_NODE_CONTAINER(node, struct savl_snode, node)->size;
+}
+
+/**
+ * Augmentation callback that maintains subtree sizes.
+ *
+ * @param node	The node, which is part of a {@link savl_snode}.
+ * @param arg	Not used.
+ *
+ * @return	Whether the node's subtree size changed.
+ */
+static _Bool savl_size_update(struct savl_node *const node,
+			      const void *const arg)
+{
+	struct savl_snode *const snode =
+		SAVL_NODE_CONTAINER(node, struct savl_snode, node);
+	size_t size;
+
+	(void)arg;
+
+	size = savl_size_of(node->left) + 1 + savl_size_of(node->right);
+	if (size == snode->size)
+		return 0;
+
+	snode->size = size;
+	return 1;
+}
+
+static const struct savl_aug savl_size_aug = { savl_size_update, NULL };
+
+/**
+ * Add a node to a tree of {@link savl_snode} structures.  Otherwise identical
+ * to savl_add().
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing, replacement of the root
+ *			node, or addition to an empty tree), <b>`*tree`</b> will
+ *			be changed to point to the new root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added, which must be part of a
+ *			{@link savl_snode}.  It's key must compare equal to
+ *			<b>`key`</b>.
+ * @param replace	If the tree already contains a node with a key equal to
+ *			<b>`key`</b>, should the new node be inserted in its
+ *			place?
+ *
+ * @return	<b>`NULL`</b> if the tree did not already contain a node with a
+ *		key equal to <b>`key`</b>, or a pointer to the pre-existing
+ *		key (which may have been replaced, depending on the value of
+ *		the <b>`replace`</b> parameter).
+ *
+ * @see	savl_snode
+ */
+struct savl_node *savl_sized_add(struct savl_node **const tree,
+				 const savl_cmpfn cmpfn,
+				 const union savl_key key,
+				 struct savl_node *const new,
+				 const _Bool replace)
+{
+	return savl_aug_add(tree, cmpfn, key, new, replace, &savl_size_aug);
+}
+
+/**
+ * Remove a node from a tree of {@link savl_snode} structures.
+ *
+ * @param node		The node to be deleted.
+ * @param[out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed (because it is deleted or the tree
+ *			is rebalanced), <b>`*tree`</b> will be set to the new
+ *			root node.
+ *
+ * @see	savl_snode
+ */
+void savl_sized_remove_node(struct savl_node *const node,
+			    struct savl_node **const tree)
+{
+	savl_remove_aug(node, tree, &savl_size_aug, SAVL_EVEN, NULL);
+}
+
+/**
+ * Remove a key from a tree of {@link savl_snode} structures.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed (because it is deleted or the tree
+ *			is rebalanced), <b>`*tree`</b> will be set to the new
+ *			root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree did not
+ *		contain a matching node.
+ *
+ * @see	savl_snode
+ */
+struct savl_node *savl_sized_remove(struct savl_node **const tree,
+				    const savl_cmpfn cmpfn,
+				    const union savl_key key)
+{
+	return savl_aug_remove(tree, cmpfn, key, &savl_size_aug);
+}
+
+/**
+ * Find the node at a particular position in a tree of {@link savl_snode}
+ * structures.
+ *
+ * @param node	The root of the tree.
+ * @param index	The (zero-based) position of the node within the tree, in key
+ *		order.
+ *
+ * @return	The node (or <b>`NULL`</b>, if <b>`index`</b> is not less than
+ *		the number of nodes in the tree).
+ *
+ * @see	savl_snode
+ */
+struct savl_node *savl_select(struct savl_node *node, size_t index)
+{
+	size_t left_size;
+
+	while (node != NULL) {
+
+		left_size = savl_size_of(node->left);
+
+		if (index == left_size)
+			return node;
+
+		if (index < left_size) {
+			node = node->left;
+		}
+		else {
+			index -= left_size + 1;
+			node = node->right;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Find the position of a node within a tree of {@link savl_snode}
+ * structures.
+ *
+ * @param node	The node.
+ *
+ * @return	The (zero-based) position of the node within its tree, in key
+ *		order.
+ *
+ * @see	savl_snode
+ */
+size_t savl_rank(const struct savl_node *node)
+{
+	size_t rank;
+
+	rank = savl_size_of(node->left);
+
+	for (; savl_parent(node) != NULL; node = savl_parent(node)) {
+		if (savl_parent(node)->right == node)
+			rank += savl_size_of(savl_parent(node)->left) + 1;
+	}
+
+	return rank;
+}
+
+/**
+ * Count the nodes in a tree of {@link savl_snode} structures whose keys are
+ * less than (or equal to) a key.
+ *
+ * @param node		The root of the tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param inclusive	Should nodes whose keys are equal to <b>`key`</b> be
+ *			counted?
+ *
+ * @return	The number of matching nodes.
+ */
+static size_t savl_count_below(const struct savl_node *node,
+			       const savl_cmpfn cmpfn,
+			       const union savl_key key,
+			       const _Bool inclusive)
+{
+	size_t count = 0;
+	int cmp_result;
+
+	while (node != NULL) {
+
+		cmp_result = cmpfn(key, node);
+
+		if (cmp_result > 0 || (cmp_result == 0 && inclusive)) {
+			/* node and its left subtree are all counted */
+			count += savl_size_of(node->left) + 1;
+			node = node->right;
+		}
+		else {
+			node = node->left;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Count the nodes in a range of keys, in a tree of {@link savl_snode}
+ * structures.
+ *
+ * @param tree		The root of the tree.
+ * @param cmpfn		Comparison function.
+ * @param lo		The lowest key in the range (inclusive).
+ * @param hi		The highest key in the range (inclusive).
+ *
+ * @return	The number of nodes with keys in the range.
+ *
+ * @see	savl_snode
+ */
+size_t savl_count_range(const struct savl_node *const tree,
+			const savl_cmpfn cmpfn,
+			const union savl_key lo, const union savl_key hi)
+{
+	size_t below_lo, through_hi;
+
+	below_lo = savl_count_below(tree, cmpfn, lo, 0);
+	through_hi = savl_count_below(tree, cmpfn, hi, 1);
+
+	/* Empty range (lo > hi) */
+	if (through_hi < below_lo)
+		return 0;
+
+	return through_hi - below_lo;
+}
+
+/*
+ *
+ * Interval trees
+ *
+ */
+
+#define SAVL_INODE(ptr)	SAVL_NODE_CONTAINER(ptr, struct savl_inode, node)
+
+/**
+ * Augmentation callback that maintains the maximum interval end of each
+ * subtree.
+ *
+ * @param node	The node, which is part of a {@link savl_inode}.
+ * @param arg	Not used.
+ *
+ * @return	Whether the node's maximum end changed.
+ */
+static _Bool savl_interval_update(struct savl_node *const node,
+				  const void *const arg)
+{
+	struct savl_inode *const inode = SAVL_INODE(node);
+	uint64_t max_end;
+
+	(void)arg;
+
+	max_end = inode->end;
+
+	if (node->left != NULL && SAVL_INODE(node->left)->max_end > max_end)
+		max_end = SAVL_INODE(node->left)->max_end;
+
+	if (node->right != NULL && SAVL_INODE(node->right)->max_end > max_end)
+		max_end = SAVL_INODE(node->right)->max_end;
+
+	if (max_end == inode->max_end)
+		return 0;
+
+	inode->max_end = max_end;
+	return 1;
+}
+
+static const struct savl_aug savl_interval_aug = { savl_interval_update, NULL };
+
+/**
+ * Comparison function for interval trees.  Intervals are ordered by start,
+ * then by end, then by the address of the node, so every node has a unique
+ * key.
+ *
+ * @param key	The key, a pointer to a {@link savl_inode} (in
+ *		<b>`key.p`</b>).
+ * @param node	The node.
+ *
+ * @return	Less than, equal to, or greater than zero, as the key is less
+ *		than, equal to, or greater than the node.
+ */
+static int savl_interval_cmp(const union savl_key key,
+			     const struct savl_node *const node)
+{
+	const struct savl_inode *const a = key.p;
+	const struct savl_inode *const b = SAVL_INODE(node);
+
+	if (a->start != b->start)
+		return a->start < b->start ? -1 : 1;
+
+	if (a->end != b->end)
+		return a->end < b->end ? -1 : 1;
+
+	if (a != b)
+		return (uintptr_t)a < (uintptr_t)b ? -1 : 1;
+
+	return 0;
+}
+
+/**
+ * Add an interval to an interval tree.
+ *
+ * The <b>`start`</b> and <b>`end`</b> members of <b>`new`</b> must be set
+ * (and <b>`start`</b> must not be greater than <b>`end`</b>).  A tree may
+ * contain any number of equal intervals.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing or addition to an empty
+ *			tree), <b>`*tree`</b> will be changed to point to the
+ *			new root node.
+ * @param new		The interval to be added.
+ *
+ * @see	savl_inode
+ */
+void savl_interval_add(struct savl_node **const tree,
+		       struct savl_inode *const new)
+{
+	union savl_key key;
+
+	assert(new->start <= new->end);
+
+	key.p = new;
+	new->max_end = new->end;
+
+	savl_aug_add(tree, savl_interval_cmp, key, &new->node, 0,
+		     &savl_interval_aug);
+}
+
+/**
+ * Remove an interval from an interval tree.
+ *
+ * @param node		The interval to be removed.
+ * @param[out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed (because it is deleted or the tree
+ *			is rebalanced), <b>`*tree`</b> will be set to the new
+ *			root node.
+ *
+ * @see	savl_inode
+ */
+void savl_interval_remove(struct savl_inode *const node,
+			  struct savl_node **const tree)
+{
+	savl_remove_aug(&node->node, tree, &savl_interval_aug, SAVL_EVEN,
+			NULL);
+}
+
+/**
+ * Visit the intervals in a subtree that overlap a range.
+ *
+ * @param node		The root of the subtree (or <b>`NULL`</b>).
+ * @param lo		The start of the range.
+ * @param hi		The end of the range.
+ * @param visitfn	Visit callback.
+ * @param arg		Argument passed to <b>`visitfn`</b>.
+ *
+ * @return	Zero, or the non-zero value returned by <b>`visitfn`</b>.
+ */
+static int savl_overlap_subtree(struct savl_node *const node,
+				const uint64_t lo, const uint64_t hi,
+				const savl_visitfn visitfn, void *const arg)
+{
+	struct savl_inode *inode;
+	int result;
+
+	/* Nothing in this subtree ends at or after lo */
+	if (node == NULL || SAVL_INODE(node)->max_end < lo)
+		return 0;
+
+	inode = SAVL_INODE(node);
+
+	result = savl_overlap_subtree(node->left, lo, hi, visitfn, arg);
+	if (result != 0)
+		return result;
+
+	/* This interval and everything to its right start after hi */
+	if (inode->start > hi)
+		return 0;
+
+	if (inode->end >= lo) {
+		result = visitfn(node, arg);
+		if (result != 0)
+			return result;
+	}
+
+	return savl_overlap_subtree(node->right, lo, hi, visitfn, arg);
+}
+
+/**
+ * Visit the intervals in an interval tree that overlap a range.
+ *
+ * Intervals are closed; an interval overlaps the range if it contains any
+ * point from <b>`lo`</b> through <b>`hi`</b> (inclusive).  Overlapping
+ * intervals are visited in order (by start, then end).
+ *
+ * The time required is O(k log(n/k) + log n), where k is the number of
+ * overlapping intervals.  The tree is ordered by start, so the search can skip
+ * only subtrees that start after <b>`hi`</b> or that contain no interval that
+ * ends at or after <b>`lo`</b>, and it may have to descend separately to each
+ * overlapping interval.  (It is O(log n + k) only if the overlapping intervals
+ * are adjacent in start order.)
+ *
+ * The visit callback must not modify the tree.
+ *
+ * @param tree		The root of the tree.
+ * @param lo		The start of the range.
+ * @param hi		The end of the range.
+ * @param visitfn	Visit callback.  (The node passed to the callback is
+ *			the <b>`node`</b> member of a {@link savl_inode}.)
+ * @param arg		Argument passed to <b>`visitfn`</b>.
+ *
+ * @return	Zero, or the non-zero value returned by <b>`visitfn`</b> (which
+ *		stops the iteration).
+ *
+ * @see	savl_inode
+ */
+int savl_interval_overlap(struct savl_node *const tree,
+			  const uint64_t lo, const uint64_t hi,
+			  const savl_visitfn visitfn, void *const arg)
+{
+	if (lo > hi)
+		return 0;
+
+	return savl_overlap_subtree(tree, lo, hi, visitfn, arg);
+}
+
+/**
+ * Visit the intervals in an interval tree that contain a point.
+ *
+ * Equivalent to savl_interval_overlap() with <b>`lo`</b> and <b>`hi`</b> both
+ * equal to <b>`point`</b>.
+ *
+ * @param tree		The root of the tree.
+ * @param point		The point.
+ * @param visitfn	Visit callback.
+ * @param arg		Argument passed to <b>`visitfn`</b>.
+ *
+ * @return	Zero, or the non-zero value returned by <b>`visitfn`</b> (which
+ *		stops the iteration).
+ *
+ * @see	savl_inode
+ */
+int savl_interval_stab(struct savl_node *const tree, const uint64_t point,
+		       const savl_visitfn visitfn, void *const arg)
+{
+	return savl_overlap_subtree(tree, point, point, visitfn, arg);
+}
+
+/*
+ *
+ * Range aggregates
+ *
+ */
+
+/**
+ * Get a pointer to the aggregate of a node.
+ *
+ * @param node		The node.
+ * @param monoid	The monoid.
+ *
+ * @return	A pointer to the node's aggregate.
+ */
+static inline void *savl_aggregate(struct savl_node *const node,
+				   const struct savl_monoid *const monoid)
+{
+	return (unsigned char *)node + monoid->aggregate_offset;
+}
+
+/**
+ * Augmentation callback that maintains the aggregate of each subtree of a
+ * tree with a monoid augmentation.  The aggregate of a node is the
+ * combination of its left child's aggregate, its own value, and its right
+ * child's aggregate, in that order.
+ *
+ * Use this function with a {@link savl_aug} whose <b>`arg`</b> member points
+ * to a {@link savl_monoid}.  For example:
+ *
+ *	static const struct savl_monoid sum_monoid = { ... };
+ *
+ *	static const struct savl_aug sum_aug = {
+ *		.fn	= savl_monoid_update,
+ *		.arg	= &sum_monoid
+ *	};
+ *
+ *	savl_aug_add(&tree, cmpfn, key, node, 0, &sum_aug);
+ *
+ * @param node	The node.
+ * @param arg	The monoid.
+ *
+ * @return	Always 1; the new aggregate is not compared with the old one,
+ *		so every ancestor of a changed node is updated.
+ *
+ * @see	savl_monoid
+ */
+_Bool savl_monoid_update(struct savl_node *const node, const void *const arg)
+{
+	const struct savl_monoid *const monoid = arg;
+	void *const agg = savl_aggregate(node, monoid);
+
+	monoid->identity(agg);
+
+	if (node->left != NULL)
+		monoid->combine(agg, savl_aggregate(node->left, monoid));
+
+	monoid->combine(agg, savl_kfield(node, monoid->value_offset));
+
+	if (node->right != NULL)
+		monoid->combine(agg, savl_aggregate(node->right, monoid));
+
+	return 1;
+}
+
+/**
+ * Combine the values of the nodes in a subtree whose keys are greater than or
+ * equal to a key, in order.
+ *
+ * @param node		The root of the subtree (or <b>`NULL`</b>).
+ * @param cmpfn		Comparison function.
+ * @param lo		The key.
+ * @param monoid	The monoid.
+ * @param acc		The accumulator.
+ */
+static void savl_reduce_from(struct savl_node *const node,
+			     const savl_cmpfn cmpfn, const union savl_key lo,
+			     const struct savl_monoid *const monoid,
+			     void *const acc)
+{
+	if (node == NULL)
+		return;
+
+	if (cmpfn(lo, node) > 0) {
+		/* node and its left subtree are below the range */
+		savl_reduce_from(node->right, cmpfn, lo, monoid, acc);
+		return;
+	}
+
+	savl_reduce_from(node->left, cmpfn, lo, monoid, acc);
+
+	monoid->combine(acc, savl_kfield(node, monoid->value_offset));
+
+	if (node->right != NULL)
+		monoid->combine(acc, savl_aggregate(node->right, monoid));
+}
+
+/**
+ * Combine the values of the nodes in a subtree whose keys are less than or
+ * equal to a key, in order.
+ *
+ * @param node		The root of the subtree (or <b>`NULL`</b>).
+ * @param cmpfn		Comparison function.
+ * @param hi		The key.
+ * @param monoid	The monoid.
+ * @param acc		The accumulator.
+ */
+static void savl_reduce_through(struct savl_node *node,
+				const savl_cmpfn cmpfn,
+				const union savl_key hi,
+				const struct savl_monoid *const monoid,
+				void *const acc)
+{
+	while (node != NULL) {
+
+		if (cmpfn(hi, node) < 0) {
+			/* node and its right subtree are above the range */
+			node = node->left;
+			continue;
+		}
+
+		if (node->left != NULL)
+			monoid->combine(acc, savl_aggregate(node->left, monoid));
+
+		monoid->combine(acc, savl_kfield(node, monoid->value_offset));
+
+		node = node->right;
+	}
+}
+
+/**
+ * Combine the values of the nodes in a range of keys.
+ *
+ * The values are combined in key order, so the monoid's combine function need
+ * not be commutative.  The time required is O(log n), regardless of the
+ * number of nodes in the range, because whole subtrees within the range are
+ * represented by their aggregates.
+ *
+ * The tree must be maintained by functions that take a {@link savl_aug} (such
+ * as savl_aug_add() and savl_aug_remove()), using savl_monoid_update() and the
+ * same monoid.
+ *
+ * @param tree		The root of the tree.
+ * @param cmpfn		Comparison function.
+ * @param lo		The lowest key in the range (inclusive).
+ * @param hi		The highest key in the range (inclusive).
+ * @param monoid	The monoid.
+ * @param[out] result	Output parameter used to return the combined value.
+ *			(The monoid's identity if the range is empty.)
+ *
+ * @see	savl_monoid
+ */
+void savl_reduce_range(struct savl_node *const tree, const savl_cmpfn cmpfn,
+		       const union savl_key lo, const union savl_key hi,
+		       const struct savl_monoid *const monoid,
+		       void *const result)
+{
+	struct savl_node *node;
+
+	monoid->identity(result);
+	node = tree;
+
+	/* Find the highest node in the range; its subtree contains the rest */
+	while (node != NULL) {
+
+		if (cmpfn(lo, node) > 0)
+			node = node->right;
+		else if (cmpfn(hi, node) < 0)
+			node = node->left;
+		else
+			break;
+	}
+
+	if (node == NULL)
+		return;
+
+	savl_reduce_from(node->left, cmpfn, lo, monoid, result);
+	monoid->combine(result, savl_kfield(node, monoid->value_offset));
+	savl_reduce_through(node->right, cmpfn, hi, monoid, result);
+}
+
+/*
+ *
+ * Index-based trees
+ *
+ * These trees use the same algorithms as the pointer-based trees above, but
+ * their links are 32-bit array indexes, and each node's skew is stored in the
+ * low-order 2 bits of its parent link.  A skew is never temporarily doubled
+ * in the stored representation; rebalancing computes the new skew in a local
+ * variable and performs any needed rotation before storing it.
+ *
+ */
+
+/**
+ * Get a pointer to an element in an index-based tree's array.
+ *
+ * @param tree	The tree.
+ * @param index	The index of the element.
+ *
+ * @return	A pointer to the element.
+ */
+static inline void *savl_idx_elm(const struct savl_idx_tree *const tree,
+				 const uint32_t index)
+{
+	return (unsigned char *)tree->base + (size_t)index * tree->stride;
+}
+
+/**
+ * Get a pointer to a node in an index-based tree.
+ *
+ * @param tree	The tree.
+ * @param index	The index of the node's element.
+ *
+ * @return	A pointer to the node.
+ */
+static inline struct savl_idx_node *savl_idx_at(
+					const struct savl_idx_tree *const tree,
+					const uint32_t index)
+{
+	return (struct savl_idx_node *)(void *)
+		((unsigned char *)savl_idx_elm(tree, index) + tree->offset);
+}
+
+static inline uint32_t savl_idx_parent(const struct savl_idx_node *const node)
+{
+	return node->parent_skew >> 2;
+}
+
+static inline void savl_idx_set_parent(struct savl_idx_node *const node,
+				       const uint32_t parent)
+{
+	node->parent_skew = (parent << 2) | (node->parent_skew & 3);
+}
+
+static inline int_fast8_t savl_idx_skew(const struct savl_idx_node *const node)
+{
+	return (int_fast8_t)(node->parent_skew & 3) - 1;
+}
+
+static inline void savl_idx_set_skew(struct savl_idx_node *const node,
+				     const int_fast8_t skew)
+{
+	assert(skew >= SAVL_LEFT && skew <= SAVL_RIGHT);
+	node->parent_skew = (node->parent_skew & ~(uint32_t)3)
+				| (uint32_t)(skew + 1);
+}
+
+/**
+ * Replace a child link in an index-based tree.
+ *
+ * @param tree		The tree.
+ * @param parent	The parent whose child link is to be changed (or
+ *			<b>`SAVL_IDX_NONE`</b> to change the root).
+ * @param old		The current child.
+ * @param new		The new child.
+ */
+static void savl_idx_relink(struct savl_idx_tree *const tree,
+			    const uint32_t parent, const uint32_t old,
+			    const uint32_t new)
+{
+	struct savl_idx_node *p;
+
+	if (parent == SAVL_IDX_NONE) {
+		tree->root = new;
+		return;
+	}
+
+	p = savl_idx_at(tree, parent);
+
+	if (p->left == old) {
+		p->left = new;
+	}
+	else {
+		assert(p->right == old);
+		p->right = new;
+	}
+}
+
+/**
+ * Rotate a subtree of an index-based tree to the left (promoting the root's
+ * right child).  Skews are not changed.
+ *
+ * @param tree	The tree.
+ * @param x	The root of the subtree.
+ *
+ * @return	The new root of the subtree.
+ */
+static uint32_t savl_idx_rotate_left(struct savl_idx_tree *const tree,
+				     const uint32_t x)
+{
+	struct savl_idx_node *const xn = savl_idx_at(tree, x);
+	const uint32_t y = xn->right;
+	struct savl_idx_node *const yn = savl_idx_at(tree, y);
+	const uint32_t parent = savl_idx_parent(xn);
+
+	xn->right = yn->left;
+	if (yn->left != SAVL_IDX_NONE)
+		savl_idx_set_parent(savl_idx_at(tree, yn->left), x);
+
+	yn->left = x;
+	savl_idx_set_parent(xn, y);
+	savl_idx_set_parent(yn, parent);
+	savl_idx_relink(tree, parent, x, y);
+
+	return y;
+}
+
+/**
+ * Rotate a subtree of an index-based tree to the right (promoting the root's
+ * left child).  Skews are not changed.
+ *
+ * @param tree	The tree.
+ * @param x	The root of the subtree.
+ *
+ * @return	The new root of the subtree.
+ */
+static uint32_t savl_idx_rotate_right(struct savl_idx_tree *const tree,
+				      const uint32_t x)
+{
+	struct savl_idx_node *const xn = savl_idx_at(tree, x);
+	const uint32_t y = xn->left;
+	struct savl_idx_node *const yn = savl_idx_at(tree, y);
+	const uint32_t parent = savl_idx_parent(xn);
+
+	xn->left = yn->right;
+	if (yn->right != SAVL_IDX_NONE)
+		savl_idx_set_parent(savl_idx_at(tree, yn->right), x);
+
+	yn->right = x;
+	savl_idx_set_parent(xn, y);
+	savl_idx_set_parent(yn, parent);
+	savl_idx_relink(tree, parent, x, y);
+
+	return y;
+}
+
+/**
+ * Rebalance a doubly skewed subtree of an index-based tree.
+ *
+ * @param tree		The tree.
+ * @param x		The root of the subtree.
+ * @param skew		The (doubled) skew of <b>`x`</b>, which is not stored in
+ *			the node.
+ * @param[out] shrank	Output parameter used to return whether the depth of
+ *			the rebalanced subtree is less than it would be if
+ *			<b>`x`</b> were singly skewed.
+ *
+ * @return	The new root of the subtree.
+ */
+static uint32_t savl_idx_rebalance(struct savl_idx_tree *const tree,
+				   const uint32_t x, const int_fast8_t skew,
+				   _Bool *const shrank)
+{
+	struct savl_idx_node *const xn = savl_idx_at(tree, x);
+	const int_fast8_t dir = skew / 2;
+	struct savl_idx_node *yn, *zn;
+	int_fast8_t yskew, zskew;
+	uint32_t y, z;
+
+	y = dir > 0 ? xn->right : xn->left;
+	yn = savl_idx_at(tree, y);
+	yskew = savl_idx_skew(yn);
+
+	if (yskew != -dir) {
+
+		/* Single rotation */
+		if (dir > 0)
+			savl_idx_rotate_left(tree, x);
+		else
+			savl_idx_rotate_right(tree, x);
+
+		if (yskew == SAVL_EVEN) {
+			/* Only possible after a deletion */
+			savl_idx_set_skew(xn, dir);
+			savl_idx_set_skew(yn, -dir);
+			*shrank = 0;
+		}
+		else {
+			savl_idx_set_skew(xn, SAVL_EVEN);
+			savl_idx_set_skew(yn, SAVL_EVEN);
+			*shrank = 1;
+		}
+
+		return y;
+	}
+
+	/* Double rotation; z is y's inner child */
+	z = dir > 0 ? yn->left : yn->right;
+	zn = savl_idx_at(tree, z);
+	zskew = savl_idx_skew(zn);
+
+	if (dir > 0) {
+		savl_idx_rotate_right(tree, y);
+		savl_idx_rotate_left(tree, x);
+	}
+	else {
+		savl_idx_rotate_left(tree, y);
+		savl_idx_rotate_right(tree, x);
+	}
+
+	savl_idx_set_skew(xn, zskew == dir ? -dir : SAVL_EVEN);
+	savl_idx_set_skew(yn, zskew == -dir ? dir : SAVL_EVEN);
+	savl_idx_set_skew(zn, SAVL_EVEN);
+	*shrank = 1;
+
+	return z;
+}
+
+/**
+ * Search an index-based tree for a key.  See savl_search().
+ *
+ * @param tree		The tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param[out] result	Output parameter used to return the index of the key's
+ *			node (or its prospective parent).
+ *
+ * @return	<b>`SAVL_LEFT`</b>, <b>`SAVL_RIGHT`</b>, or
+ *		<b>`SAVL_EVEN`</b>.
+ */
+static int_fast8_t savl_idx_search(const struct savl_idx_tree *const tree,
+				   const savl_idx_cmpfn cmpfn,
+				   const union savl_key key,
+				   uint32_t *const result)
+{
+	const struct savl_idx_node *node;
+	uint32_t index, next;
+	int cmp_result;
+
+	index = tree->root;
+	*result = SAVL_IDX_NONE;
+
+	while (index != SAVL_IDX_NONE) {
+
+		*result = index;
+		cmp_result = cmpfn(key, savl_idx_elm(tree, index));
+
+		if (cmp_result == 0)
+			return SAVL_EVEN;
+
+		node = savl_idx_at(tree, index);
+		next = cmp_result < 0 ? node->left : node->right;
+
+		if (next == SAVL_IDX_NONE)
+			return cmp_result < 0 ? SAVL_LEFT : SAVL_RIGHT;
+
+		index = next;
+	}
+
+	return SAVL_EVEN;
+}
+
+/**
+ * Replace a node in an index-based tree with a node that has the same key.
+ *
+ * @param tree	The tree.
+ * @param old	The node to be replaced.
+ * @param new	The replacement node.
+ */
+static void savl_idx_replace(struct savl_idx_tree *const tree,
+			     const uint32_t old, const uint32_t new)
+{
+	struct savl_idx_node *const on = savl_idx_at(tree, old);
+	struct savl_idx_node *const nn = savl_idx_at(tree, new);
+
+	*nn = *on;
+
+	if (nn->left != SAVL_IDX_NONE)
+		savl_idx_set_parent(savl_idx_at(tree, nn->left), new);
+	if (nn->right != SAVL_IDX_NONE)
+		savl_idx_set_parent(savl_idx_at(tree, nn->right), new);
+
+	savl_idx_relink(tree, savl_idx_parent(nn), old, new);
+}
+
+/**
+ * Add a node to an index-based tree.  Otherwise identical to savl_add().
+ *
+ * @param tree		The tree.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param index		The index of the element to be added.  It's key must
+ *			compare equal to <b>`key`</b>.
+ * @param replace	If the tree already contains an element with a key
+ *			equal to <b>`key`</b>, should the new element be
+ *			inserted in its place?
+ *
+ * @return	<b>`SAVL_IDX_NONE`</b> if the tree did not already contain an
+ *		element with a key equal to <b>`key`</b>, or the index of the
+ *		pre-existing element (which may have been replaced, depending
+ *		on the value of the <b>`replace`</b> parameter).
+ *
+ * @see	savl_idx_tree
+ */
+uint32_t savl_idx_add(struct savl_idx_tree *const tree,
+		      const savl_idx_cmpfn cmpfn, const union savl_key key,
+		      const uint32_t index, const _Bool replace)
+{
+	struct savl_idx_node *node, *pn;
+	uint32_t parent, child;
+	int_fast8_t dir, skew;
+	_Bool shrank;
+
+	assert(index < SAVL_IDX_NONE);
+
+	dir = savl_idx_search(tree, cmpfn, key, &parent);
+
+	if (dir == SAVL_EVEN && parent != SAVL_IDX_NONE) {
+		if (replace)
+			savl_idx_replace(tree, parent, index);
+		return parent;
+	}
+
+	node = savl_idx_at(tree, index);
+	node->left = SAVL_IDX_NONE;
+	node->right = SAVL_IDX_NONE;
+	node->parent_skew = (parent << 2) | (uint32_t)(SAVL_EVEN + 1);
+
+	if (parent == SAVL_IDX_NONE) {
+		tree->root = index;
+		return SAVL_IDX_NONE;
+	}
+
+	pn = savl_idx_at(tree, parent);
+	if (dir < 0)
+		pn->left = index;
+	else
+		pn->right = index;
+
+	/* Adjust skews upward until the subtree depth stops growing */
+	child = index;
+
+	while (parent != SAVL_IDX_NONE) {
+
+		pn = savl_idx_at(tree, parent);
+		skew = savl_idx_skew(pn) + (pn->left == child ? -1 : 1);
+
+		if (skew == SAVL_DBL_LEFT || skew == SAVL_DBL_RIGHT) {
+			/* Rotation restores the subtree's original depth */
+			savl_idx_rebalance(tree, parent, skew, &shrank);
+			break;
+		}
+
+		savl_idx_set_skew(pn, skew);
+
+		if (skew == SAVL_EVEN)
+			break;
+
+		child = parent;
+		parent = savl_idx_parent(pn);
+	}
+
+	return SAVL_IDX_NONE;
+}
+
+/**
+ * Remove a node from an index-based tree.
+ *
+ * @param tree	The tree.
+ * @param index	The index of the element to be removed.
+ *
+ * @see	savl_idx_tree
+ */
+void savl_idx_remove_node(struct savl_idx_tree *const tree,
+			  const uint32_t index)
+{
+	struct savl_idx_node *const node = savl_idx_at(tree, index);
+	struct savl_idx_node *rn, *pn;
+	uint32_t repl, parent, child;
+	int_fast8_t dir, skew;
+	_Bool shrank;
+
+	if (node->left != SAVL_IDX_NONE && node->right != SAVL_IDX_NONE) {
+
+		/* Replace the node with its successor */
+		repl = node->right;
+		rn = savl_idx_at(tree, repl);
+
+		while (rn->left != SAVL_IDX_NONE) {
+			repl = rn->left;
+			rn = savl_idx_at(tree, repl);
+		}
+
+		if (repl == node->right) {
+			parent = repl;
+			dir = SAVL_RIGHT;
+		}
+		else {
+			parent = savl_idx_parent(rn);
+			dir = SAVL_LEFT;
+
+			pn = savl_idx_at(tree, parent);
+			pn->left = rn->right;
+			if (rn->right != SAVL_IDX_NONE)
+				savl_idx_set_parent(
+					savl_idx_at(tree, rn->right), parent);
+
+			rn->right = node->right;
+			savl_idx_set_parent(savl_idx_at(tree, rn->right),
+					    repl);
+		}
+
+		rn->left = node->left;
+		savl_idx_set_parent(savl_idx_at(tree, rn->left), repl);
+		rn->parent_skew = node->parent_skew;
+		savl_idx_relink(tree, savl_idx_parent(node), index, repl);
+	}
+	else {
+		child = node->left != SAVL_IDX_NONE ? node->left : node->right;
+		parent = savl_idx_parent(node);
+
+		if (child != SAVL_IDX_NONE)
+			savl_idx_set_parent(savl_idx_at(tree, child), parent);
+
+		if (parent != SAVL_IDX_NONE) {
+			pn = savl_idx_at(tree, parent);
+			dir = pn->left == index ? SAVL_LEFT : SAVL_RIGHT;
+		}
+		else {
+			dir = SAVL_EVEN;
+		}
+
+		savl_idx_relink(tree, parent, index, child);
+	}
+
+	/* The dir subtree of parent shrank; adjust skews upward */
+	while (parent != SAVL_IDX_NONE) {
+
+		pn = savl_idx_at(tree, parent);
+		skew = savl_idx_skew(pn) - dir;
+
+		if (skew == SAVL_DBL_LEFT || skew == SAVL_DBL_RIGHT) {
+			parent = savl_idx_rebalance(tree, parent, skew,
+						    &shrank);
+			if (!shrank)
+				break;
+			pn = savl_idx_at(tree, parent);
+		}
+		else {
+			savl_idx_set_skew(pn, skew);
+			if (skew != SAVL_EVEN)
+				break;
+		}
+
+		/* Subtree rooted at parent shrank; propagate upward */
+		child = parent;
+		parent = savl_idx_parent(pn);
+
+		if (parent != SAVL_IDX_NONE) {
+			pn = savl_idx_at(tree, parent);
+			dir = pn->left == child ? SAVL_LEFT : SAVL_RIGHT;
+		}
+	}
+}
+
+/**
+ * Remove a key from an index-based tree.
+ *
+ * @param tree	The tree.
+ * @param cmpfn	Comparison function.
+ * @param key	The key.
+ *
+ * @return	The index of the element that was removed (or
+ *		<b>`SAVL_IDX_NONE`</b> if the tree did not contain a matching
+ *		element).
+ *
+ * @see	savl_idx_tree
+ */
+uint32_t savl_idx_remove(struct savl_idx_tree *const tree,
+			 const savl_idx_cmpfn cmpfn, const union savl_key key)
+{
+	uint32_t index;
+
+	if (savl_idx_search(tree, cmpfn, key, &index) != SAVL_EVEN
+						|| index == SAVL_IDX_NONE) {
+		return SAVL_IDX_NONE;
+	}
+
+	savl_idx_remove_node(tree, index);
+
+	return index;
+}
+
+/**
+ * Find the element in an index-based tree with a key.
+ *
+ * @param tree	The tree.
+ * @param cmpfn	Comparison function.
+ * @param key	The key.
+ *
+ * @return	The index of the element with a matching key (or
+ *		<b>`SAVL_IDX_NONE`</b> if the tree does not contain a matching
+ *		element).
+ *
+ * @see	savl_idx_tree
+ */
+uint32_t savl_idx_get(const struct savl_idx_tree *const tree,
+		      const savl_idx_cmpfn cmpfn, const union savl_key key)
+{
+	uint32_t index;
+	int cmp_result;
+
+	index = tree->root;
+
+	while (index != SAVL_IDX_NONE) {
+
+		cmp_result = cmpfn(key, savl_idx_elm(tree, index));
+
+		if (cmp_result == 0)
+			break;
+
+		if (cmp_result < 0)
+			index = savl_idx_at(tree, index)->left;
+		else
+			index = savl_idx_at(tree, index)->right;
+	}
+
+	return index;
+}
+
+/**
+ * Find the first (lowest key) element in an index-based tree.
+ *
+ * @param tree	The tree.
+ *
+ * @return	The index of the first element (or <b>`SAVL_IDX_NONE`</b> if
+ *		the tree is empty).
+ *
+ * @see	savl_idx_tree
+ */
+uint32_t savl_idx_first(const struct savl_idx_tree *const tree)
+{
+	uint32_t index;
+
+	index = tree->root;
+	if (index == SAVL_IDX_NONE)
+		return SAVL_IDX_NONE;
+
+	while (savl_idx_at(tree, index)->left != SAVL_IDX_NONE)
+		index = savl_idx_at(tree, index)->left;
+
+	return index;
+}
+
+/**
+ * Find the last (highest key) element in an index-based tree.
+ *
+ * @param tree	The tree.
+ *
+ * @return	The index of the last element (or <b>`SAVL_IDX_NONE`</b> if
+ *		the tree is empty).
+ *
+ * @see	savl_idx_tree
+ */
+uint32_t savl_idx_last(const struct savl_idx_tree *const tree)
+{
+	uint32_t index;
+
+	index = tree->root;
+	if (index == SAVL_IDX_NONE)
+		return SAVL_IDX_NONE;
+
+	while (savl_idx_at(tree, index)->right != SAVL_IDX_NONE)
+		index = savl_idx_at(tree, index)->right;
+
+	return index;
+}
+
+/**
+ * Find the next element in an index-based tree.
+ *
+ * @param tree	The tree.
+ * @param index	The index of the current element.
+ *
+ * @return	The index of the element with the next higher key (or
+ *		<b>`SAVL_IDX_NONE`</b> if <b>`index`</b> is the last element).
+ *
+ * @see	savl_idx_tree
+ */
+uint32_t savl_idx_next(const struct savl_idx_tree *const tree, uint32_t index)
+{
+	const struct savl_idx_node *node;
+	uint32_t parent;
+
+	node = savl_idx_at(tree, index);
+
+	if (node->right != SAVL_IDX_NONE) {
+		index = node->right;
+		while (savl_idx_at(tree, index)->left != SAVL_IDX_NONE)
+			index = savl_idx_at(tree, index)->left;
+		return index;
+	}
+
+	/* Move up until we move up from a left child */
+	while ((parent = savl_idx_parent(node)) != SAVL_IDX_NONE) {
+		node = savl_idx_at(tree, parent);
+		if (node->left == index)
+			return parent;
+		index = parent;
+	}
+
+	return SAVL_IDX_NONE;
+}
+
+/**
+ * Find the previous element in an index-based tree.
+ *
+ * @param tree	The tree.
+ * @param index	The index of the current element.
+ *
+ * @return	The index of the element with the next lower key (or
+ *		<b>`SAVL_IDX_NONE`</b> if <b>`index`</b> is the first element).
+ *
+ * @see	savl_idx_tree
+ */
+uint32_t savl_idx_prev(const struct savl_idx_tree *const tree, uint32_t index)
+{
+	const struct savl_idx_node *node;
+	uint32_t parent;
+
+	node = savl_idx_at(tree, index);
+
+	if (node->left != SAVL_IDX_NONE) {
+		index = node->left;
+		while (savl_idx_at(tree, index)->right != SAVL_IDX_NONE)
+			index = savl_idx_at(tree, index)->right;
+		return index;
+	}
+
+	/* Move up until we move up from a right child */
+	while ((parent = savl_idx_parent(node)) != SAVL_IDX_NONE) {
+		node = savl_idx_at(tree, parent);
+		if (node->right == index)
+			return parent;
+		index = parent;
+	}
+
+	return SAVL_IDX_NONE;
+}
+
+/*
+ *
+ * Parent-free trees
+ *
+ * Nodes of these trees have no parent pointer.  Insertion and deletion record
+ * the path from the root in an on-stack array of link addresses, and the
+ * rebalancing loops walk back along that path.
+ *
+ */
+
+/**
+ * Rebalance a doubly skewed subtree of a parent-free tree.
+ *
+ * @param x		The root of the subtree.
+ * @param skew		The (doubled) skew of <b>`x`</b>.
+ * @param[out] shrank	Output parameter used to return whether the depth of
+ *			the rebalanced subtree is less than it would be if
+ *			<b>`x`</b> were singly skewed.
+ *
+ * @return	The new root of the subtree.
+ */
+static struct savl_pf_node *savl_pf_rebalance(struct savl_pf_node *const x,
+					      const int_fast8_t skew,
+					      _Bool *const shrank)
+{
+	const int_fast8_t dir = skew / 2;
+	struct savl_pf_node *y, *z;
+
+	y = dir > 0 ? x->right : x->left;
+
+	if (y->skew != -dir) {
+
+		/* Single rotation */
+		if (dir > 0) {
+			x->right = y->left;
+			y->left = x;
+		}
+		else {
+			x->left = y->right;
+			y->right = x;
+		}
+
+		if (y->skew == SAVL_EVEN) {
+			/* Only possible after a deletion */
+			x->skew = dir;
+			y->skew = -dir;
+			*shrank = 0;
+		}
+		else {
+			x->skew = SAVL_EVEN;
+			y->skew = SAVL_EVEN;
+			*shrank = 1;
+		}
+
+		return y;
+	}
+
+	/* Double rotation; z is y's inner child */
+	if (dir > 0) {
+		z = y->left;
+		y->left = z->right;
+		x->right = z->left;
+		z->right = y;
+		z->left = x;
+	}
+	else {
+		z = y->right;
+		y->right = z->left;
+		x->left = z->right;
+		z->left = y;
+		z->right = x;
+	}
+
+	x->skew = z->skew == dir ? -dir : SAVL_EVEN;
+	y->skew = z->skew == -dir ? dir : SAVL_EVEN;
+	z->skew = SAVL_EVEN;
+	*shrank = 1;
+
+	return z;
+}
+
+/**
+ * Add a node to a parent-free tree.  Otherwise identical to savl_add().
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root is changed (by rebalancing, replacement of the root
+ *			node, or addition to an empty tree), <b>`*tree`</b> will
+ *			be changed to point to the new root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ * @param new		The node to be added.  It's key must compare equal to
+ *			<b>`key`</b>.
+ * @param replace	If the tree already contains a node with a key equal to
+ *			<b>`key`</b>, should the new node be inserted in its
+ *			place?
+ *
+ * @return	<b>`NULL`</b> if the tree did not already contain a node with a
+ *		key equal to <b>`key`</b>, or a pointer to the pre-existing
+ *		node (which may have been replaced, depending on the value of
+ *		the <b>`replace`</b> parameter).
+ *
+ * @see	savl_pf_node
+ */
+struct savl_pf_node *savl_pf_add(struct savl_pf_node **const tree,
+				 const savl_pf_cmpfn cmpfn,
+				 const union savl_key key,
+				 struct savl_pf_node *const new,
+				 const _Bool replace)
+{
+	struct savl_pf_node **path[SAVL_MAX_DEPTH];
+	int_fast8_t dirs[SAVL_MAX_DEPTH];
+	struct savl_pf_node **link, *node;
+	int_fast8_t skew;
+	int cmp_result;
+	unsigned int depth;
+	_Bool shrank;
+
+	link = tree;
+	depth = 0;
+
+	while (*link != NULL) {
+
+		node = *link;
+		cmp_result = cmpfn(key, node);
+
+		if (cmp_result == 0) {
+			if (replace) {
+				new->left = node->left;
+				new->right = node->right;
+				new->skew = node->skew;
+				*link = new;
+			}
+			return node;
+		}
+
+		assert(depth < SAVL_MAX_DEPTH);
+		path[depth] = link;
+
+		if (cmp_result < 0) {
+			dirs[depth] = SAVL_LEFT;
+			link = &node->left;
+		}
+		else {
+			dirs[depth] = SAVL_RIGHT;
+			link = &node->right;
+		}
+
+		++depth;
+	}
+
+	new->left = NULL;
+	new->right = NULL;
+	new->skew = SAVL_EVEN;
+	*link = new;
+
+	/* Adjust skews upward until the subtree depth stops growing */
+	while (depth-- > 0) {
+
+		node = *path[depth];
+		skew = node->skew + dirs[depth];
+
+		if (skew == SAVL_DBL_LEFT || skew == SAVL_DBL_RIGHT) {
+			/* Rotation restores the subtree's original depth */
+			*path[depth] = savl_pf_rebalance(node, skew, &shrank);
+			break;
+		}
+
+		node->skew = skew;
+
+		if (skew == SAVL_EVEN)
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * Remove a key from a parent-free tree.
+ *
+ * @param[in,out] tree	A double pointer to the root node of the tree.  If the
+ *			root node is changed (because it is deleted or the tree
+ *			is rebalanced), <b>`*tree`</b> will be set to the new
+ *			root node.
+ * @param cmpfn		Comparison function.
+ * @param key		The key.
+ *
+ * @return	The node that was removed (or <b>`NULL`</b> if the tree did not
+ *		contain a matching node.
+ *
+ * @see	savl_pf_node
+ */
+struct savl_pf_node *savl_pf_remove(struct savl_pf_node **const tree,
+				    const savl_pf_cmpfn cmpfn,
+				    const union savl_key key)
+{
+	struct savl_pf_node **path[SAVL_MAX_DEPTH];
+	int_fast8_t dirs[SAVL_MAX_DEPTH];
+	struct savl_pf_node **link, *node, *removed, *repl;
+	unsigned int depth, found;
+	int_fast8_t skew;
+	int cmp_result;
+	_Bool shrank;
+
+	link = tree;
+	depth = 0;
+
+	while (1) {
+
+		node = *link;
+		if (node == NULL)
+			return NULL;
+
+		cmp_result = cmpfn(key, node);
+		if (cmp_result == 0)
+			break;
+
+		assert(depth < SAVL_MAX_DEPTH);
+		path[depth] = link;
+
+		if (cmp_result < 0) {
+			dirs[depth] = SAVL_LEFT;
+			link = &node->left;
+		}
+		else {
+			dirs[depth] = SAVL_RIGHT;
+			link = &node->right;
+		}
+
+		++depth;
+	}
+
+	removed = node;
+
+	if (node->left == NULL || node->right == NULL) {
+		*link = node->left != NULL ? node->left : node->right;
+	}
+	else {
+		/* Replace the node with its successor */
+		found = depth;
+		path[depth] = link;
+		dirs[depth++] = SAVL_RIGHT;
+		link = &node->right;
+
+		while ((*link)->left != NULL) {
+			assert(depth < SAVL_MAX_DEPTH);
+			path[depth] = link;
+			dirs[depth++] = SAVL_LEFT;
+			link = &(*link)->left;
+		}
+
+		repl = *link;
+		*link = repl->right;
+
+		repl->left = node->left;
+		repl->right = node->right;
+		repl->skew = node->skew;
+		*path[found] = repl;
+
+		/* The path now goes through the replacement */
+		if (depth > found + 1)
+			path[found + 1] = &repl->right;
+	}
+
+	/* The subtree in direction dirs[depth] shrank; adjust skews upward */
+	while (depth-- > 0) {
+
+		node = *path[depth];
+		skew = node->skew - dirs[depth];
+
+		if (skew == SAVL_DBL_LEFT || skew == SAVL_DBL_RIGHT) {
+			*path[depth] = savl_pf_rebalance(node, skew, &shrank);
+			if (!shrank)
+				break;
+		}
+		else {
+			node->skew = skew;
+			if (skew != SAVL_EVEN)
+				break;
+		}
+	}
+
+	return removed;
+}
+
+/**
+ * Find the node in a parent-free tree with a key.
+ *
+ * @param node	The root of the tree.
+ * @param cmpfn	Comparison function.
+ * @param key	The key.
+ *
+ * @return	The node with a matching key (or <b>`NULL`</b> if the tree does
+ *		not contain a matching node).
+ *
+ * @see	savl_pf_node
+ */
+struct savl_pf_node *savl_pf_get(struct savl_pf_node *node,
+				 const savl_pf_cmpfn cmpfn,
+				 const union savl_key key)
+{
+	int cmp_result;
+
+	while (node != NULL) {
+
+		cmp_result = cmpfn(key, node);
+
+		if (cmp_result == 0)
+			break;
+
+		node = cmp_result < 0 ? node->left : node->right;
+	}
+
+	return node;
+}
+
+/* savl_pf_descend() and savl_pf_step() */
+SAVL_PATH_FUNCS(savl_pf, struct savl_pf_cursor, struct savl_pf_node)
+
+/**
+ * Position a cursor at the first (lowest key) node in a parent-free tree.
+ *
+ * @param[out] cursor	The cursor.
+ * @param tree		The root of the tree.
+ *
+ * @return	The first node (or <b>`NULL`</b> if the tree is empty).
+ *
+ * @see	savl_pf_cursor
+ */
+struct savl_pf_node *savl_pf_first(struct savl_pf_cursor *const cursor,
+				   struct savl_pf_node *const tree)
+{
+	cursor->depth = 0;
+	return savl_pf_descend(cursor, tree, SAVL_LEFT);
+}
+
+/**
+ * Position a cursor at the last (highest key) node in a parent-free tree.
+ *
+ * @param[out] cursor	The cursor.
+ * @param tree		The root of the tree.
+ *
+ * @return	The last node (or <b>`NULL`</b> if the tree is empty).
+ *
+ * @see	savl_pf_cursor
+ */
+struct savl_pf_node *savl_pf_last(struct savl_pf_cursor *const cursor,
+				  struct savl_pf_node *const tree)
+{
+	cursor->depth = 0;
+	return savl_pf_descend(cursor, tree, SAVL_RIGHT);
+}
+
+/**
+ * Move a cursor to the next node in its tree.
+ *
+ * @param cursor	The cursor.
+ *
+ * @return	The node with the next higher key (or <b>`NULL`</b> if the
+ *		cursor was positioned at the last node).
+ *
+ * @see	savl_pf_cursor
+ */
+struct savl_pf_node *savl_pf_next(struct savl_pf_cursor *const cursor)
+{
+	return savl_pf_step(cursor, SAVL_RIGHT);
+}
+
+/**
+ * Move a cursor to the previous node in its tree.
+ *
+ * @param cursor	The cursor.
+ *
+ * @return	The node with the next lower key (or <b>`NULL`</b> if the
+ *		cursor was positioned at the first node).
+ *
+ * @see	savl_pf_cursor
+ */
+struct savl_pf_node *savl_pf_prev(struct savl_pf_cursor *const cursor)
+{
+	return savl_pf_step(cursor, SAVL_LEFT);
+}
+
+/*
+ *
+ * Parallel bulk and set operations
+ *
+ */
+
+/**
+ * Build a tree from an array of nodes that are sorted by key.
+ *
+ * The middle node of the array becomes the root, and the two halves of the
+ * array become its subtrees, so the tree is perfectly balanced.  No keys are
+ * compared.
+ *
+ * @param nodes		The nodes.
+ * @param count		The number of nodes.
+ * @param[out] height	Output parameter used to return the depth of the tree.
+ *
+ * @return	The root of the tree.
+ */
+static struct savl_node *savl_build_depth(struct savl_node *const *const nodes,
+					  const size_t count,
+					  int *const height)
+{
+	struct savl_node *root;
+	int left_h, right_h;
+
+	if (count == 0) {
+		*height = 0;
+		return NULL;
+	}
+
+	root = nodes[count / 2];
+	savl_set_parent(root, NULL);
+	root->left = savl_build_depth(nodes, count / 2, &left_h);
+	root->right = savl_build_depth(nodes + count / 2 + 1,
+				       count - count / 2 - 1, &right_h);
+
+	if (root->left != NULL)
+		savl_set_parent(root->left, root);
+	if (root->right != NULL)
+		savl_set_parent(root->right, root);
+
+	/* The left half is never smaller than the right half */
+	savl_set_skew(root, right_h - left_h);
+	*height = left_h + 1;
+
+	return root;
+}
+
+/**
+ * Build a tree from an array of nodes that are sorted by key.
+ *
+ * The tree is perfectly balanced, and it is built in O(n) time, without
+ * calling a comparison function.
+ *
+ * @param nodes		The nodes.  They must be sorted in ascending order by
+ *			key, with no duplicate keys.
+ * @param count		The number of nodes.
+ * @param[out] tree	Output parameter used to return the root of the tree.
+ *			(Any nodes that were previously in the tree are
+ *			ignored.)
+ */
+void savl_build_sorted(struct savl_node *const *const nodes, const size_t count,
+		       struct savl_node **const tree)
+{
+	int height;
+
+	*tree = savl_build_depth(nodes, count, &height);
+}
+
+/**
+ * Find the first of an array of keys that is not less than a node's key.
+ *
+ * @param node		The node.
+ * @param cmpfn		Comparison function.
+ * @param keys		The keys, sorted in ascending order.
+ * @param count		The number of keys.
+ *
+ * @return	The index of the first key that is greater than or equal to the
+ *		key of <b>`node`</b>, or <b>`count`</b>.
+ */
+static size_t savl_key_partition(const struct savl_node *const node,
+				 const savl_cmpfn cmpfn,
+				 const union savl_key *const keys,
+				 const size_t count)
+{
+	size_t lo, hi, mid;
+
+	lo = 0;
+	hi = count;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (cmpfn(keys[mid], node) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * Find the first of an array of nodes whose key is not less than another
+ * node's key.
+ *
+ * @param node		The node.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param nodes		The nodes, sorted in ascending order.
+ * @param count		The number of nodes.
+ *
+ * @return	The index of the first node in <b>`nodes`</b> whose key is
+ *		greater than or equal to the key of <b>`node`</b>, or
+ *		<b>`count`</b>.
+ */
+static size_t savl_node_partition(const struct savl_node *const node,
+				  const savl_cmpfn cmpfn,
+				  const savl_keyfn keyfn,
+				  struct savl_node *const *const nodes,
+				  const size_t count)
+{
+	size_t lo, hi, mid;
+
+	lo = 0;
+	hi = count;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (cmpfn(keyfn(nodes[mid]), node) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * Recursively add an array of nodes to a tree.
+ *
+ * The tree's root is used to partition the array, the nodes on each side of the
+ * root are added to the root's subtrees, and the results are joined.
+ *
+ * @param tree		The root of the tree.
+ * @param height	The depth of the tree.
+ * @param nodes		The nodes to be added, sorted by key (with no duplicate
+ *			keys).
+ * @param count		The number of nodes to be added.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free nodes whose keys are already
+ *			in the tree, or <b>`NULL`</b>.
+ * @param[out] new_h	Output parameter used to return the depth of the
+ *			resulting tree.
+ *
+ * @return	The root of the resulting tree.
+ */
+static struct savl_node *savl_add_bulk_depth(struct savl_node *const tree,
+					     const int height,
+					     struct savl_node *const *const
+								nodes,
+					     const size_t count,
+					     const savl_cmpfn cmpfn,
+					     const savl_keyfn keyfn,
+					     const savl_freefn freefn,
+					     int *const new_h)
+{
+	struct savl_node *left, *right;
+	int left_h, right_h;
+	size_t i, skip;
+
+	if (count == 0) {
+		*new_h = height;
+		return tree;
+	}
+
+	if (tree == NULL)
+		return savl_build_depth(nodes, count, new_h);
+
+	i = savl_node_partition(tree, cmpfn, keyfn, nodes, count);
+	skip = (i < count && cmpfn(keyfn(nodes[i]), tree) == 0);
+	if (skip)
+		savl_discard_node(nodes[i], freefn);
+
+	savl_detach_root(tree, height, &left, &left_h, &right, &right_h);
+
+	left = savl_add_bulk_depth(left, left_h, nodes, i,
+				   cmpfn, keyfn, freefn, &left_h);
+	right = savl_add_bulk_depth(right, right_h, nodes + i + skip,
+				    count - i - skip,
+				    cmpfn, keyfn, freefn, &right_h);
+
+	return savl_join_depth(left, left_h, tree, right, right_h, new_h);
+}
+
+/**
+ * Recursively remove an array of keys from a tree.
+ *
+ * @param tree		The root of the tree.
+ * @param height	The depth of the tree.
+ * @param keys		The keys to be removed, sorted in ascending order.
+ * @param count		The number of keys.
+ * @param cmpfn		Comparison function.
+ * @param freefn	Callback function to free the removed nodes, or
+ *			<b>`NULL`</b>.
+ * @param[out] new_h	Output parameter used to return the depth of the
+ *			resulting tree.
+ *
+ * @return	The root of the resulting tree.
+ *
+ * @see	savl_add_bulk_depth
+ */
+static struct savl_node *savl_remove_bulk_depth(struct savl_node *const tree,
+						const int height,
+						const union savl_key *const
+								keys,
+						const size_t count,
+						const savl_cmpfn cmpfn,
+						const savl_freefn freefn,
+						int *const new_h)
+{
+	struct savl_node *left, *right;
+	int left_h, right_h;
+	size_t i, found;
+
+	if (count == 0 || tree == NULL) {
+		*new_h = height;
+		return tree;
+	}
+
+	i = savl_key_partition(tree, cmpfn, keys, count);
+	found = (i < count && cmpfn(keys[i], tree) == 0);
+
+	savl_detach_root(tree, height, &left, &left_h, &right, &right_h);
+
+	left = savl_remove_bulk_depth(left, left_h, keys, i,
+				      cmpfn, freefn, &left_h);
+	right = savl_remove_bulk_depth(right, right_h, keys + i + found,
+				       count - i - found,
+				       cmpfn, freefn, &right_h);
+
+	if (found) {
+		savl_discard_node(tree, freefn);
+		return savl_join2_depth(left, left_h, right, right_h, new_h);
+	}
+
+	return savl_join_depth(left, left_h, tree, right, right_h, new_h);
+}
+
+/*
+ * Subproblems smaller than these are not split across threads.  (A tree of
+ * depth 14 contains at least 986 nodes.)
+ */
+#define SAVL_PAR_MIN_DEPTH	14
+#define SAVL_PAR_MIN_COUNT	1024
+
+/* Maximum number of tasks waiting in one worker's deque */
+#define SAVL_DEQUE_SIZE		256
+
+struct savl_worker;
+
+/* A unit of work that can be run by any thread in a pool */
+struct savl_task {
+	void			(*fn)(struct savl_task *task,
+				      struct savl_worker *self);
+	struct savl_task	*next;		/* pool's queue of root tasks */
+	int			done;		/* accessed atomically */
+	_Bool			root;		/* not forked by a worker */
+};
+
+/* A worker thread and its deque of tasks */
+struct savl_worker {
+	struct savl_pool	*pool;
+	pthread_t		thread;
+	pthread_mutex_t		lock;
+	unsigned int		head;		/* steal from here */
+	unsigned int		tail;		/* push/pop here */
+	unsigned int		seed;		/* picks steal victims */
+	struct savl_task	*deque[SAVL_DEQUE_SIZE];
+};
+
+/**
+ * Thread pool structure.
+ *
+ * Each worker pushes the tasks that it forks onto its own deque, and runs them
+ * itself (most recent first) unless they are stolen (oldest first) by an idle
+ * worker.  Threads that are waiting for a forked task to complete run other
+ * forked tasks in the meantime.  Root tasks are run in the order in which they
+ * were queued, and only by workers that are not waiting for anything.
+ *
+ * <b>`queue`</b>, <b>`pending`</b> and <b>`idle`</b> are read without holding
+ * <b>`lock`</b>, so they are always written atomically.
+ */
+struct savl_pool {
+	pthread_mutex_t		lock;
+	pthread_cond_t		work_cond;	/* work is available */
+	pthread_cond_t		done_cond;	/* a root task is done */
+	struct savl_task	*queue;		/* root tasks (oldest first) */
+	struct savl_task	*queue_tail;	/* newest root task */
+	unsigned int		pending;	/* forked, not started */
+	unsigned int		idle;		/* waiting for work_cond */
+	unsigned int		nworkers;
+	_Bool			shutdown;
+	struct savl_worker	workers[];
+};
+
+/**
+ * Run a task and mark it as done.
+ *
+ * @param task	The task.
+ * @param self	The worker that is running the task.
+ */
+static void savl_task_run(struct savl_task *const task,
+			  struct savl_worker *const self)
+{
+	struct savl_pool *const pool = self->pool;
+
+	task->fn(task, self);
+
+	if (!task->root) {
+		__atomic_store_n(&task->done, 1, __ATOMIC_RELEASE);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	task->done = 1;
+	pthread_cond_broadcast(&pool->done_cond);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Find a task for a worker to run.
+ *
+ * Checks the worker's own deque, the pool's queue of root tasks (if
+ * <b>`roots`</b> is true), and the other workers' deques (starting at a random
+ * worker), in that order.
+ *
+ * A worker that is waiting for a forked task must not start a root task, which
+ * could run for much longer than the task that it is waiting for (and which
+ * could itself wait for tasks that can only be run by this worker).
+ *
+ * @param self	The worker.
+ * @param roots	Whether the task may be taken from the queue of root tasks.
+ *
+ * @return	A task (which has been removed from its deque or queue), or
+ *		<b>`NULL`</b>.
+ */
+static struct savl_task *savl_task_find(struct savl_worker *const self,
+					 const _Bool roots)
+{
+	struct savl_pool *const pool = self->pool;
+	struct savl_worker *victim;
+	struct savl_task *task;
+	unsigned int i, start;
+
+	task = NULL;
+
+	pthread_mutex_lock(&self->lock);
+	if (self->tail > self->head)
+		task = self->deque[--self->tail];
+	pthread_mutex_unlock(&self->lock);
+
+	if (task != NULL)
+		goto found;
+
+	if (roots && __atomic_load_n(&pool->queue, __ATOMIC_RELAXED) != NULL) {
+		pthread_mutex_lock(&pool->lock);
+		task = pool->queue;
+		if (task != NULL) {
+			__atomic_store_n(&pool->queue, task->next,
+					 __ATOMIC_RELAXED);
+			if (task->next == NULL)
+				pool->queue_tail = NULL;
+		}
+		pthread_mutex_unlock(&pool->lock);
+		if (task != NULL)
+			return task;
+	}
+
+	if (__atomic_load_n(&pool->pending, __ATOMIC_RELAXED) == 0)
+		return NULL;
+
+	self->seed = self->seed * 1103515245 + 12345;
+	start = (self->seed >> 16) % pool->nworkers;
+
+	for (i = 0; i < pool->nworkers; ++i) {
+
+		victim = &pool->workers[(start + i) % pool->nworkers];
+		if (victim == self)
+			continue;
+
+		pthread_mutex_lock(&victim->lock);
+		if (victim->tail > victim->head)
+			task = victim->deque[victim->head++];
+		pthread_mutex_unlock(&victim->lock);
+
+		if (task != NULL)
+			goto found;
+	}
+
+	return NULL;
+
+found:
+	__atomic_fetch_sub(&pool->pending, 1, __ATOMIC_RELAXED);
+	return task;
+}
+
+/**
+ * Make a task available to other workers.
+ *
+ * @param self	The worker that is forking the task (or <b>`NULL`</b>, if the
+ *		calling thread is not a pool worker).
+ * @param task	The task.
+ *
+ * @return	<b>`1`</b> if the task was forked, or <b>`0`</b> if it must be
+ *		run by the caller.
+ */
+static _Bool savl_task_fork(struct savl_worker *const self,
+			    struct savl_task *const task)
+{
+	struct savl_pool *pool;
+
+	if (self == NULL)
+		return 0;
+
+	pool = self->pool;
+	task->done = 0;
+	task->root = 0;
+
+	pthread_mutex_lock(&self->lock);
+
+	if (self->tail == SAVL_DEQUE_SIZE && self->head > 0) {
+		memmove(self->deque, self->deque + self->head,
+			(self->tail - self->head) * sizeof self->deque[0]);
+		self->tail -= self->head;
+		self->head = 0;
+	}
+
+	if (self->tail == SAVL_DEQUE_SIZE) {
+		pthread_mutex_unlock(&self->lock);
+		return 0;
+	}
+
+	self->deque[self->tail++] = task;
+	pthread_mutex_unlock(&self->lock);
+
+	/*
+	 * A worker increments idle before it checks pending and waits, so
+	 * either it sees this task or it is seen here (and woken).
+	 */
+	__atomic_fetch_add(&pool->pending, 1, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&pool->idle, __ATOMIC_SEQ_CST) != 0) {
+		pthread_mutex_lock(&pool->lock);
+		pthread_cond_signal(&pool->work_cond);
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	return 1;
+}
+
+/**
+ * Wait for a forked task to complete, running other tasks in the meantime.
+ *
+ * @param self	The worker that forked the task.
+ * @param task	The task.
+ */
+static void savl_task_join(struct savl_worker *const self,
+			   struct savl_task *const task)
+{
+	struct savl_task *other;
+
+	while (!__atomic_load_n(&task->done, __ATOMIC_ACQUIRE)) {
+
+		other = savl_task_find(self, 0);
+
+		if (other != NULL)
+			savl_task_run(other, self);
+		else
+			sched_yield();
+	}
+}
+
+/**
+ * Worker thread function.
+ *
+ * @param arg	The worker.
+ *
+ * @return	<b>`NULL`</b>.
+ */
+static void *savl_worker_main(void *const arg)
+{
+	struct savl_worker *const self = arg;
+	struct savl_pool *const pool = self->pool;
+	struct savl_task *task;
+
+	while (1) {
+
+		task = savl_task_find(self, 1);
+
+		if (task != NULL) {
+			savl_task_run(task, self);
+			continue;
+		}
+
+		pthread_mutex_lock(&pool->lock);
+		__atomic_fetch_add(&pool->idle, 1, __ATOMIC_SEQ_CST);
+
+		while (!pool->shutdown && pool->queue == NULL
+				&& __atomic_load_n(&pool->pending,
+						   __ATOMIC_SEQ_CST) == 0) {
+			pthread_cond_wait(&pool->work_cond, &pool->lock);
+		}
+
+		__atomic_fetch_sub(&pool->idle, 1, __ATOMIC_RELAXED);
+
+		if (pool->shutdown) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+/**
+ * Run a task on a pool and wait for it to complete.
+ *
+ * @param pool	The pool, or <b>`NULL`</b>.  (If <b>`pool`</b> is
+ *		<b>`NULL`</b>, the task is run by the calling thread, and it
+ *		does not fork any other tasks.)
+ * @param task	The task.
+ */
+static void savl_pool_run(struct savl_pool *const pool,
+			  struct savl_task *const task)
+{
+	if (pool == NULL) {
+		task->fn(task, NULL);
+		return;
+	}
+
+	task->done = 0;
+	task->root = 1;
+
+	pthread_mutex_lock(&pool->lock);
+
+	task->next = NULL;
+	if (pool->queue_tail != NULL)
+		pool->queue_tail->next = task;
+	else
+		__atomic_store_n(&pool->queue, task, __ATOMIC_RELAXED);
+	pool->queue_tail = task;
+	pthread_cond_signal(&pool->work_cond);
+
+	while (!task->done)
+		pthread_cond_wait(&pool->done_cond, &pool->lock);
+
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Create a thread pool for parallel tree operations.
+ *
+ * @param threads	The number of worker threads.  If <b>`threads`</b> is
+ *			zero, one thread is created for each online CPU.
+ *
+ * @return	The new thread pool, or <b>`NULL`</b> (with <b>`errno`</b>
+ *		set) on error.
+ *
+ * @see	savl_pool_destroy
+ */
+struct savl_pool *savl_pool_create(unsigned int threads)
+{
+	struct savl_pool *pool;
+	struct savl_worker *w;
+	unsigned int i;
+	long cpus;
+	int err;
+
+	if (threads == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cpus > 0 ? (unsigned int)cpus : 1;
+	}
+
+	pool = calloc(1, sizeof *pool + threads * sizeof pool->workers[0]);
+	if (pool == NULL)
+		return NULL;
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->work_cond, NULL);
+	pthread_cond_init(&pool->done_cond, NULL);
+	pool->nworkers = threads;
+
+	for (i = 0; i < threads; ++i) {
+		w = &pool->workers[i];
+		w->pool = pool;
+		w->seed = i;
+		pthread_mutex_init(&w->lock, NULL);
+	}
+
+	for (i = 0; i < threads; ++i) {
+
+		w = &pool->workers[i];
+		err = pthread_create(&w->thread, NULL, savl_worker_main, w);
+
+		if (err != 0) {
+			pool->nworkers = i;
+			savl_pool_destroy(pool);
+			errno = err;
+			return NULL;
+		}
+	}
+
+	return pool;
+}
+
+/**
+ * Stop the worker threads of a thread pool and free its resources.
+ *
+ * @param pool	The thread pool.  It must not be in use.
+ *
+ * @see	savl_pool_create
+ */
+void savl_pool_destroy(struct savl_pool *const pool)
+{
+	unsigned int i;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->shutdown = 1;
+	pthread_cond_broadcast(&pool->work_cond);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = 0; i < pool->nworkers; ++i)
+		pthread_join(pool->workers[i].thread, NULL);
+
+	for (i = 0; i < pool->nworkers; ++i)
+		pthread_mutex_destroy(&pool->workers[i].lock);
+
+	pthread_cond_destroy(&pool->done_cond);
+	pthread_cond_destroy(&pool->work_cond);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool);
+}
+
+/* Parallel operations */
+enum savl_par_op {
+	SAVL_PAR_UNION,
+	SAVL_PAR_INTER,
+	SAVL_PAR_DIFF,
+	SAVL_PAR_ADD,
+	SAVL_PAR_REMOVE
+};
+
+/* Parameters that are shared by all of the tasks of a parallel operation */
+struct savl_par_args {
+	enum savl_par_op	op;
+	savl_cmpfn		cmpfn;
+	savl_keyfn		keyfn;
+	savl_freefn		freefn;
+};
+
+/* One (sub)problem of a parallel operation */
+struct savl_par_task {
+	struct savl_task		task;
+	const struct savl_par_args	*args;
+	struct savl_node		*t1;
+	struct savl_node		*t2;		/* set operations */
+	struct savl_node *const		*nodes;		/* bulk add */
+	const union savl_key		*keys;		/* bulk remove */
+	size_t				count;
+	int				h1;
+	int				h2;
+	struct savl_node		*result;
+	int				height;
+};
+
+/**
+ * Solve a subproblem of a parallel operation sequentially.
+ *
+ * @param pt	The subproblem.
+ */
+static void savl_par_seq(struct savl_par_task *const pt)
+{
+	const struct savl_par_args *const a = pt->args;
+
+	switch (a->op) {
+
+		case SAVL_PAR_UNION:
+			pt->result = savl_union_depth(pt->t1, pt->h1,
+						      pt->t2, pt->h2,
+						      a->cmpfn, a->keyfn,
+						      a->freefn, &pt->height);
+			break;
+
+		case SAVL_PAR_INTER:
+			pt->result = savl_inter_depth(pt->t1, pt->h1,
+						      pt->t2, pt->h2,
+						      a->cmpfn, a->keyfn,
+						      a->freefn, &pt->height);
+			break;
+
+		case SAVL_PAR_DIFF:
+			pt->result = savl_diff_depth(pt->t1, pt->h1,
+						     pt->t2, pt->h2,
+						     a->cmpfn, a->keyfn,
+						     a->freefn, &pt->height);
+			break;
+
+		case SAVL_PAR_ADD:
+			pt->result = savl_add_bulk_depth(pt->t1, pt->h1,
+							 pt->nodes, pt->count,
+							 a->cmpfn, a->keyfn,
+							 a->freefn,
+							 &pt->height);
+			break;
+
+		case SAVL_PAR_REMOVE:
+			pt->result = savl_remove_bulk_depth(pt->t1, pt->h1,
+							    pt->keys,
+							    pt->count,
+							    a->cmpfn,
+							    a->freefn,
+							    &pt->height);
+			break;
+	}
+}
+
+/**
+ * Is a subproblem of a parallel operation too small to be split across
+ * threads?
+ *
+ * @param pt	The subproblem.
+ *
+ * @return	<b>`1`</b> if the subproblem should be solved sequentially, or
+ *		<b>`0`</b> if it should be split.
+ */
+static _Bool savl_par_small(const struct savl_par_task *const pt)
+{
+	switch (pt->args->op) {
+
+		case SAVL_PAR_ADD:
+			/* Building a tree from an empty tree is cheap */
+			return pt->t1 == NULL || pt->count < SAVL_PAR_MIN_COUNT;
+
+		case SAVL_PAR_REMOVE:
+			return pt->h1 < SAVL_PAR_MIN_DEPTH
+				|| pt->count < SAVL_PAR_MIN_COUNT;
+
+		default:
+			return pt->h1 < SAVL_PAR_MIN_DEPTH
+				|| pt->h2 < SAVL_PAR_MIN_DEPTH;
+	}
+}
+
+static void savl_par_task_fn(struct savl_task *task, struct savl_worker *self);
+
+/**
+ * Solve a subproblem of a parallel operation, splitting it into two smaller
+ * subproblems (one of which may be run by another thread) if it is large
+ * enough.
+ *
+ * Each split follows the same steps as the corresponding sequential function;
+ * see savl_union_depth(), savl_inter_depth(), savl_diff_depth(),
+ * savl_add_bulk_depth(), and savl_remove_bulk_depth().
+ *
+ * @param pt	The subproblem.
+ * @param self	The worker that is solving the subproblem (or <b>`NULL`</b>,
+ *		if the calling thread is not a pool worker).
+ */
+static void savl_par_solve(struct savl_par_task *const pt,
+			   struct savl_worker *const self)
+{
+	const struct savl_par_args *const a = pt->args;
+	struct savl_par_task left, right;
+	struct savl_node *root, *dup;
+	size_t i, skip;
+	_Bool forked;
+
+	if (self == NULL || savl_par_small(pt)) {
+		savl_par_seq(pt);
+		return;
+	}
+
+	left = *pt;
+	right = *pt;
+	left.task.fn = savl_par_task_fn;
+	dup = NULL;
+	skip = 0;
+
+	switch (a->op) {
+
+		case SAVL_PAR_UNION:
+		case SAVL_PAR_INTER:
+			root = pt->t1;
+			savl_detach_root(root, pt->h1, &left.t1, &left.h1,
+					 &right.t1, &right.h1);
+			dup = savl_split_depth(pt->t2, pt->h2, a->cmpfn,
+					       a->keyfn(root),
+					       &left.t2, &left.h2,
+					       &right.t2, &right.h2);
+			break;
+
+		case SAVL_PAR_DIFF:
+			root = pt->t2;
+			savl_detach_root(root, pt->h2, &left.t2, &left.h2,
+					 &right.t2, &right.h2);
+			dup = savl_split_depth(pt->t1, pt->h1, a->cmpfn,
+					       a->keyfn(root),
+					       &left.t1, &left.h1,
+					       &right.t1, &right.h1);
+			break;
+
+		case SAVL_PAR_ADD:
+			root = pt->t1;
+			i = savl_node_partition(root, a->cmpfn, a->keyfn,
+						pt->nodes, pt->count);
+			skip = (i < pt->count
+				&& a->cmpfn(a->keyfn(pt->nodes[i]), root) == 0);
+			if (skip)
+				dup = pt->nodes[i];
+			left.count = i;
+			right.nodes = pt->nodes + i + skip;
+			right.count = pt->count - i - skip;
+			savl_detach_root(root, pt->h1, &left.t1, &left.h1,
+					 &right.t1, &right.h1);
+			break;
+
+		case SAVL_PAR_REMOVE:
+		default:
+			root = pt->t1;
+			i = savl_key_partition(root, a->cmpfn,
+					       pt->keys, pt->count);
+			skip = (i < pt->count
+				&& a->cmpfn(pt->keys[i], root) == 0);
+			left.count = i;
+			right.keys = pt->keys + i + skip;
+			right.count = pt->count - i - skip;
+			savl_detach_root(root, pt->h1, &left.t1, &left.h1,
+					 &right.t1, &right.h1);
+			break;
+	}
+
+	forked = savl_task_fork(self, &left.task);
+	savl_par_solve(&right, self);
+	if (forked)
+		savl_task_join(self, &left.task);
+	else
+		savl_par_solve(&left, self);
+
+	switch (a->op) {
+
+		case SAVL_PAR_UNION:
+		case SAVL_PAR_ADD:
+			savl_discard_node(dup, a->freefn);
+			pt->result = savl_join_depth(left.result, left.height,
+						     root,
+						     right.result, right.height,
+						     &pt->height);
+			break;
+
+		case SAVL_PAR_INTER:
+			if (dup != NULL) {
+				savl_discard_node(dup, a->freefn);
+				pt->result = savl_join_depth(left.result,
+							     left.height, root,
+							     right.result,
+							     right.height,
+							     &pt->height);
+				break;
+			}
+			savl_discard_node(root, a->freefn);
+			pt->result = savl_join2_depth(left.result, left.height,
+						      right.result,
+						      right.height,
+						      &pt->height);
+			break;
+
+		case SAVL_PAR_DIFF:
+			savl_discard_node(dup, a->freefn);
+			savl_discard_node(root, a->freefn);
+			pt->result = savl_join2_depth(left.result, left.height,
+						      right.result,
+						      right.height,
+						      &pt->height);
+			break;
+
+		case SAVL_PAR_REMOVE:
+			if (skip) {
+				savl_discard_node(root, a->freefn);
+				pt->result = savl_join2_depth(left.result,
+							      left.height,
+							      right.result,
+							      right.height,
+							      &pt->height);
+				break;
+			}
+			pt->result = savl_join_depth(left.result, left.height,
+						     root,
+						     right.result, right.height,
+						     &pt->height);
+			break;
+	}
+}
+
+/**
+ * Task function for the subproblems of parallel operations.
+ *
+ * @param task	The task, which is part of a {@link savl_par_task}.
+ * @param self	The worker that is running the task.
+ */
+static void savl_par_task_fn(struct savl_task *const task,
+			     struct savl_worker *const self)
+{
+	struct savl_par_task *pt;
+
+	pt = (struct savl_par_task *)(void *)
+		((unsigned char *)task - offsetof(struct savl_par_task, task));
+
+	savl_par_solve(pt, self);
+}
+
+/**
+ * Run a parallel operation.
+ *
+ * @param pool		The thread pool (or <b>`NULL`</b>).
+ * @param pt		The top-level problem.
+ */
+static void savl_par_run(struct savl_pool *const pool,
+			 struct savl_par_task *const pt)
+{
+	pt->task.fn = savl_par_task_fn;
+	pt->h1 = savl_height(pt->t1);
+	pt->h2 = savl_height(pt->t2);
+
+	savl_pool_run(pool, &pt->task);
+}
+
+/**
+ * Merge one tree into another, using a thread pool.
+ *
+ * The result is the same as that of savl_union(), and <b>`cmpfn`</b> and
+ * <b>`keyfn`</b> are called with the same trees' nodes.  <b>`freefn`</b> (if
+ * any) may be called concurrently from multiple threads.
+ *
+ * @param pool		The thread pool.  (If <b>`pool`</b> is <b>`NULL`</b>,
+ *			the operation is performed by the calling thread.)
+ * @param[in,out] tree	A double pointer to the root node of the first tree.
+ *			<b>`*tree`</b> is set to the root of the merged tree.
+ * @param[in,out] other	A double pointer to the root node of the second tree.
+ *			<b>`*other`</b> is set to <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free the discarded nodes, or
+ *			<b>`NULL`</b>.
+ *
+ * @see savl_union
+ */
+void savl_par_union(struct savl_pool *const pool,
+		    struct savl_node **const tree,
+		    struct savl_node **const other,
+		    const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		    const savl_freefn freefn)
+{
+	const struct savl_par_args args = {
+		SAVL_PAR_UNION, cmpfn, keyfn, freefn
+	};
+	struct savl_par_task pt = { .args = &args, .t1 = *tree, .t2 = *other };
+
+	savl_par_run(pool, &pt);
+	*tree = pt.result;
+	*other = NULL;
+}
+
+/**
+ * Intersect one tree with another, using a thread pool.
+ *
+ * The result is the same as that of savl_intersection(), and <b>`cmpfn`</b>
+ * and <b>`keyfn`</b> are called with the same trees' nodes.  <b>`freefn`</b>
+ * (if any) may be called concurrently from multiple threads.
+ *
+ * @param pool		The thread pool.  (If <b>`pool`</b> is <b>`NULL`</b>,
+ *			the operation is performed by the calling thread.)
+ * @param[in,out] tree	A double pointer to the root node of the first tree.
+ *			<b>`*tree`</b> is set to the root of the resulting
+ *			tree.
+ * @param[in,out] other	A double pointer to the root node of the second tree.
+ *			<b>`*other`</b> is set to <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free the discarded nodes, or
+ *			<b>`NULL`</b>.
+ *
+ * @see savl_intersection
+ */
+void savl_par_intersection(struct savl_pool *const pool,
+			   struct savl_node **const tree,
+			   struct savl_node **const other,
+			   const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+			   const savl_freefn freefn)
+{
+	const struct savl_par_args args = {
+		SAVL_PAR_INTER, cmpfn, keyfn, freefn
+	};
+	struct savl_par_task pt = { .args = &args, .t1 = *tree, .t2 = *other };
+
+	savl_par_run(pool, &pt);
+	*tree = pt.result;
+	*other = NULL;
+}
+
+/**
+ * Remove the keys in one tree from another, using a thread pool.
+ *
+ * The result is the same as that of savl_difference(), and <b>`cmpfn`</b>
+ * and <b>`keyfn`</b> are called with the same trees' nodes.  <b>`freefn`</b>
+ * (if any) may be called concurrently from multiple threads.
+ *
+ * @param pool		The thread pool.  (If <b>`pool`</b> is <b>`NULL`</b>,
+ *			the operation is performed by the calling thread.)
+ * @param[in,out] tree	A double pointer to the root node of the first tree.
+ *			<b>`*tree`</b> is set to the root of the resulting
+ *			tree.
+ * @param[in,out] other	A double pointer to the root node of the second tree.
+ *			<b>`*other`</b> is set to <b>`NULL`</b>.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free the discarded nodes, or
+ *			<b>`NULL`</b>.
+ *
+ * @see savl_difference
+ */
+void savl_par_difference(struct savl_pool *const pool,
+			 struct savl_node **const tree,
+			 struct savl_node **const other,
+			 const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+			 const savl_freefn freefn)
+{
+	const struct savl_par_args args = {
+		SAVL_PAR_DIFF, cmpfn, keyfn, freefn
+	};
+	struct savl_par_task pt = { .args = &args, .t1 = *tree, .t2 = *other };
+
+	savl_par_run(pool, &pt);
+	*tree = pt.result;
+	*other = NULL;
+}
+
+/**
+ * Add an array of nodes to a tree, using a thread pool.
+ *
+ * Nodes whose keys are already present in the tree are not added.  The cost
+ * is O(m log(n/m + 1)), where m is the number of nodes in the array and n is
+ * the number of nodes in the tree, divided among the threads of the pool.
+ *
+ * @param pool		The thread pool.  (If <b>`pool`</b> is <b>`NULL`</b>,
+ *			the operation is performed by the calling thread.)
+ * @param[in,out] tree	A double pointer to the root node of the tree.
+ *			<b>`*tree`</b> is set to the new root node.
+ * @param nodes		The nodes to be added.  They must be sorted in ascending
+ *			order by key, with no duplicate keys.
+ * @param count		The number of nodes to be added.
+ * @param cmpfn		Comparison function.
+ * @param keyfn		Key function.
+ * @param freefn	Callback function to free nodes that are not added
+ *			(because their keys are already present), or
+ *			<b>`NULL`</b>.  It may be called concurrently from
+ *			multiple threads.
+ */
+void savl_par_add_bulk(struct savl_pool *const pool,
+		       struct savl_node **const tree,
+		       struct savl_node *const *const nodes, const size_t count,
+		       const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		       const savl_freefn freefn)
+{
+	const struct savl_par_args args = {
+		SAVL_PAR_ADD, cmpfn, keyfn, freefn
+	};
+	struct savl_par_task pt = {
+		.args = &args, .t1 = *tree, .nodes = nodes, .count = count
+	};
+
+	savl_par_run(pool, &pt);
+	*tree = pt.result;
+}
+
+/**
+ * Remove an array of keys from a tree, using a thread pool.
+ *
+ * The cost is O(m log(n/m + 1)), where m is the number of keys and n is the
+ * number of nodes in the tree, divided among the threads of the pool.
+ *
+ * @param pool		The thread pool.  (If <b>`pool`</b> is <b>`NULL`</b>,
+ *			the operation is performed by the calling thread.)
+ * @param[in,out] tree	A double pointer to the root node of the tree.
+ *			<b>`*tree`</b> is set to the new root node.
+ * @param keys		The keys to be removed.  They must be sorted in
+ *			ascending order.
+ * @param count		The number of keys.
+ * @param cmpfn		Comparison function.
+ * @param freefn	Callback function to free the removed nodes, or
+ *			<b>`NULL`</b>.  It may be called concurrently from
+ *			multiple threads.
+ */
+void savl_par_remove_bulk(struct savl_pool *const pool,
+			  struct savl_node **const tree,
+			  const union savl_key *const keys, const size_t count,
+			  const savl_cmpfn cmpfn, const savl_freefn freefn)
+{
+	const struct savl_par_args args = {
+		SAVL_PAR_REMOVE, cmpfn, NULL, freefn
+	};
+	struct savl_par_task pt = {
+		.args = &args, .t1 = *tree, .keys = keys, .count = count
+	};
+
+	savl_par_run(pool, &pt);
+	*tree = pt.result;
 }
@@ -20,14 +20,87 @@
  * This structure should be embedded within the data structures that are to be
  * stored in the tree.
  *
+ * If <b>`SAVL_COMPACT_NODE`</b> is defined, the node's skew is stored in the
+ * low-order bits of its parent pointer, which reduces the size of the
+ * structure from 32 bytes to 24 bytes on 64-bit platforms.  The macro must be
+ * defined (or not defined) consistently when building the library and every
+ * program that uses it.  The parent pointer and skew are private to the
+ * library in either case.
+ *
  * @see	SAVL_NODE_CONTAINER
  */
+#ifdef SAVL_COMPACT_NODE
+struct savl_node {
+	uintptr_t		parent_skew;
+	struct savl_node	*left;
+	struct savl_node	*right;
+} __attribute__((aligned(8)));
+#else
 struct savl_node {
 	struct savl_node	*parent;
 	struct savl_node	*left;
 	struct savl_node	*right;
 	int_fast8_t		skew;
 };
+#endif
+
+/**
+ * AVL tree node structure with subtree size.
+ *
+ * Trees of these structures support order statistic queries, such as
+ * savl_select().  They must be modified only by functions that maintain the
+ * subtree size, such as savl_sized_add(), savl_sized_remove(), and
+ * savl_sized_remove_node().  The <b>`node`</b> member is used with all other
+ * functions.  For example:
+ *
+ *	struct product {
+ *		unsigned int		sku;
+ *		unsigned int		price;
+ *		struct savl_snode	avl;
+ *		char			*description;
+ *	};
+ *
+ *	struct product *node_to_product(struct savl_node *node)
+ *	{
+ *		return SAVL_NODE_CONTAINER(node, struct product, avl.node);
+ *	}
+ *
+ * @see	savl_node
+ */
+struct savl_snode {
+	struct savl_node	node;
+	size_t			size;	/**< Number of nodes in subtree */
+};
+
+/**
+ * Interval tree node structure.
+ *
+ * Each node represents the closed interval from <b>`start`</b> through
+ * <b>`end`</b>.  Trees of these structures support overlap queries, such as
+ * savl_interval_overlap(), which take O(k log(n/k) + log n) time to find k
+ * overlapping intervals.  They must be modified only by
+ * savl_interval_add() and savl_interval_remove(), which maintain the
+ * <b>`max_end`</b> member.  (The <b>`start`</b> and <b>`end`</b> members of a
+ * node must not be changed while it is in a tree.)  For example:
+ *
+ *	struct lease {
+ *		struct savl_inode	avl;
+ *		char			*owner;
+ *	};
+ *
+ *	struct lease *node_to_lease(struct savl_node *node)
+ *	{
+ *		return SAVL_NODE_CONTAINER(node, struct lease, avl.node);
+ *	}
+ *
+ * @see	savl_node
+ */
+struct savl_inode {
+	struct savl_node	node;
+	uint64_t		start;		/**< Start of interval */
+	uint64_t		end;		/**< End of interval */
+	uint64_t		max_end;	/**< Greatest end in subtree */
+};
 
 /**
  * Returns a pointer to the data structure that contains a {@link savl_node}.
@@ -132,14 +205,487 @@ typedef int (*savl_cmpfn)(union savl_key key, const struct savl_node *node);
  */
 typedef void (*savl_freefn)(struct savl_node *node);
 
+struct savl_tree;
+
+/**
+ * Insertion point.
+ *
+ * Records the result of a search by savl_locate() (or savl_tree_locate()), so
+ * that a node can later be added by savl_link_at() without searching the tree
+ * again.  The members of this structure are private.
+ *
+ * @see	savl_locate
+ */
+struct savl_point {
+	struct savl_node	**tree;
+	struct savl_tree	*handle;
+	struct savl_node	*node;
+	int			dir;
+};
+
+/**
+ * Entry used to add a node to one of several trees with savl_multi_add().
+ *
+ * Each entry identifies its tree by either the address of its root node
+ * (<b>`tree`</b>) or its {@link savl_tree} handle (<b>`handle`</b>).  The
+ * other member must be <b>`NULL`</b>.
+ *
+ * @see	savl_multi_add
+ */
+struct savl_multi_entry {
+	struct savl_node	**tree;		/**< Root of the tree */
+	struct savl_tree	*handle;	/**< Tree handle */
+	savl_cmpfn		cmpfn;		/**< Comparison function */
+	union savl_key		key;		/**< Key of node */
+	struct savl_node	*node;		/**< Node to be added */
+	struct savl_point	point;		/**< Private */
+};
+
+/**
+ * Callback function type to create a data structure that contains a
+ * {@link savl_node}, for savl_find_or_insert().  For example, this function
+ * uses its context argument to count the structures that it creates:
+ *
+ *	struct savl_node *new_sku(union savl_key key, void *ctx)
+ *	{
+ *		struct product *prod;
+ *
+ *		prod = calloc(1, sizeof *prod);
+ *		if (prod == NULL)
+ *			return NULL;
+ *
+ *		prod->sku = key.u;
+ *		++*(unsigned int *)ctx;
+ *
+ *		return &prod->avl;
+ *	}
+ *
+ * @param key	The key of the new node.
+ * @param ctx	The context argument passed to savl_find_or_insert().
+ *
+ * @return	The new node (or <b>`NULL`</b>, if the structure could not be
+ *		created).
+ *
+ * @see	savl_find_or_insert
+ */
+typedef struct savl_node *(*savl_ctorfn)(union savl_key key, void *ctx);
+
+/**
+ * Key types that can be described by a {@link savl_keydesc}.
+ *
+ * 32-bit integer keys are passed to the library functions directly, in the
+ * <b>`.i`</b> (signed) or <b>`.u`</b> (unsigned) member of a {@link savl_key}.
+ * All other types of keys are passed by reference, in the <b>`.p`</b> member.
+ *
+ * A NaN <b>`double`</b> compares equal to every other value, so NaN keys (in
+ * the tree or passed to a search) are not allowed.  Passing a NaN key, or a
+ * type that is not listed here, is a program error.
+ *
+ * @see	savl_keydesc
+ */
+enum savl_keytype {
+	SAVL_KEY_INT32,		/**< <b>`int32_t`</b>, passed in <b>`.i`</b> */
+	SAVL_KEY_UINT32,	/**< <b>`uint32_t`</b>, passed in <b>`.u`</b> */
+	SAVL_KEY_INT64,		/**< <b>`int64_t`</b>, passed in <b>`.p`</b> */
+	SAVL_KEY_UINT64,	/**< <b>`uint64_t`</b>, passed in <b>`.p`</b> */
+	SAVL_KEY_DOUBLE,	/**< <b>`double`</b> (not NaN), passed in
+				     <b>`.p`</b> */
+	SAVL_KEY_BYTES		/**< Fixed-length byte string, compared with
+				     <b>`memcmp()`</b>, passed in <b>`.p`</b> */
+};
+
+/**
+ * Key descriptor structure.
+ *
+ * Describes a key that is stored at a fixed offset from the {@link savl_node}
+ * within the containing data structure.  Functions that accept a key
+ * descriptor, such as savl_kget(), compare keys directly, rather than calling
+ * a {@link savl_cmpfn}.  For example:
+ *
+ *	struct product {
+ *		unsigned int		price;
+ *		struct savl_node	avl;
+ *		char			*description;
+ *		uint32_t		sku;
+ *	};
+ *
+ *	static const struct savl_keydesc sku_desc = {
+ *		.offset	= SAVL_KEY_OFFSET(struct product, avl, sku),
+ *		.type	= SAVL_KEY_UINT32
+ *	};
+ *
+ *	struct product *get_product(struct savl_node *tree, uint32_t sku)
+ *	{
+ *		union savl_key key = { .u = sku };
+ *		struct savl_node *node;
+ *
+ *		node = savl_kget(tree, &sku_desc, key);
+ *		return node ? SAVL_NODE_CONTAINER(node, struct product, avl)
+ *			    : NULL;
+ *	}
+ *
+ * @see	savl_keytype
+ * @see	SAVL_KEY_OFFSET
+ */
+struct savl_keydesc {
+	ptrdiff_t		offset;	/**< Offset of key from node */
+	enum savl_keytype	type;	/**< Type of the key */
+	size_t			len;	/**< Length of {@link SAVL_KEY_BYTES}
+					     keys */
+};
+
+/**
+ * Calculates the offset of a key from the {@link savl_node} within a
+ * containing data structure, for use in a {@link savl_keydesc}.
+ *
+ * @param type		The type of the containing structure.
+ * @param member	The name of the {@link savl_node} member within the
+ *			containing structure.
+ * @param key		The name of the key member within the containing
+ *			structure.
+ *
+ * @see	savl_keydesc
+ */
+#define SAVL_KEY_OFFSET(type, member, key)	\
+	((ptrdiff_t)offsetof(type, key) - (ptrdiff_t)offsetof(type, member))
+
+/**
+ * Key callback function type.
+ *
+ * Functions that operate on two trees, such as savl_union(), must compare the
+ * nodes of one tree with the nodes of the other.  A key function returns the
+ * key of the structure containing <b>`node`</b>, in the form expected by the
+ * trees' comparison function.  For example:
+ *
+ *	union savl_key sku_key(const struct savl_node *node)
+ *	{
+ *		const struct product *prod;
+ *		union savl_key key;
+ *
+ *		prod = SAVL_NODE_CONTAINER(node, struct product, avl);
+ *		key.u = prod->sku;
+ *
+ *		return key;
+ *	}
+ *
+ * @see savl_key
+ * @see savl_cmpfn
+ */
+typedef union savl_key (*savl_keyfn)(const struct savl_node *node);
+
+/**
+ * Callback function type used to visit the nodes in a tree (or part of a
+ * tree).
+ *
+ * @param node	The node being visited.
+ * @param arg	The argument that was passed to the iterating function.
+ *
+ * @return	Zero to continue the iteration, or a non-zero value to stop it.
+ *		(The non-zero value is returned by the iterating function.)
+ *
+ * @see savl_foreach_range
+ */
+typedef int (*savl_visitfn)(struct savl_node *node, void *arg);
+
+/**
+ * Augmentation callback function type.
+ *
+ * An augmented tree stores data in each node that is computed from the node's
+ * own key or value and the data of its children -- for example, the sum or
+ * maximum of a value over the node's subtree.  The callback recomputes that
+ * data for a single node, assuming that its children's data is current, and
+ * returns whether it changed.  For example:
+ *
+ *	_Bool max_price_update(struct savl_node *node, const void *arg)
+ *	{
+ *		struct product *prod, *child;
+ *		unsigned int max;
+ *
+ *		prod = SAVL_NODE_CONTAINER(node, struct product, avl);
+ *		max = prod->price;
+ *
+ *		if (node->left != NULL) {
+ *			child = SAVL_NODE_CONTAINER(node->left,
+ *						    struct product, avl);
+ *			if (child->max_price > max)
+ *				max = child->max_price;
+ *		}
+ *
+ *		... same for node->right ...
+ *
+ *		if (max == prod->max_price)
+ *			return 0;
+ *
+ *		prod->max_price = max;
+ *		return 1;
+ *	}
+ *
+ * The callback is called bottom up, only for nodes whose subtrees have
+ * changed, so an update costs O(log n) calls.  Returning zero when the data
+ * is unchanged allows the update to stop early.  (Returning 1 unconditionally
+ * is always correct, but slower.)
+ *
+ * The callback must not modify the tree.
+ *
+ * @param node	The node whose augmented data is to be recomputed.
+ * @param arg	The <b>`arg`</b> member of the {@link savl_aug} structure.
+ *
+ * @return	Whether the node's augmented data changed.
+ *
+ * @see	savl_aug
+ */
+typedef _Bool (*savl_augfn)(struct savl_node *node, const void *arg);
+
+/**
+ * Augmentation callback and its argument.
+ *
+ * Augmented trees must be modified only by functions that take one of these
+ * structures, such as savl_aug_add() and savl_aug_remove(); other functions
+ * that change the shape of a tree (savl_add(), savl_join(), savl_union(),
+ * etc.) do not maintain augmented data.
+ *
+ * @see	savl_augfn
+ */
+struct savl_aug {
+	savl_augfn	fn;	/**< Callback */
+	const void	*arg;	/**< Argument passed to callback */
+};
+
+/**
+ * Monoid used to maintain subtree aggregates.
+ *
+ * Each node's containing structure holds a value and an aggregate of the same
+ * type.  savl_monoid_update() sets each node's aggregate to the combination
+ * of all of the values in its subtree, in key order, and savl_reduce_range()
+ * uses the aggregates to combine the values in a range of keys.  For example:
+ *
+ *	struct counter {
+ *		uint32_t		key;
+ *		uint64_t		count;
+ *		uint64_t		total;
+ *		struct savl_node	avl;
+ *	};
+ *
+ *	static void sum_identity(void *out)
+ *	{
+ *		*(uint64_t *)out = 0;
+ *	}
+ *
+ *	static void sum_combine(void *acc, const void *val)
+ *	{
+ *		*(uint64_t *)acc += *(const uint64_t *)val;
+ *	}
+ *
+ *	static const struct savl_monoid sum_monoid = {
+ *		.value_offset		= SAVL_KEY_OFFSET(struct counter,
+ *							  avl, count),
+ *		.aggregate_offset	= SAVL_KEY_OFFSET(struct counter,
+ *							  avl, total),
+ *		.identity		= sum_identity,
+ *		.combine		= sum_combine
+ *	};
+ *
+ * @see	savl_monoid_update
+ * @see	savl_reduce_range
+ */
+struct savl_monoid {
+	ptrdiff_t	value_offset;	/**< Offset of value from node */
+	ptrdiff_t	aggregate_offset; /**< Offset of aggregate from node */
+	void		(*identity)(void *out);	/**< Set out to identity */
+	void		(*combine)(void *acc, const void *val);
+						/**< acc = acc + val */
+};
+
+/**
+ * Tree handle.
+ *
+ * A handle keeps the number of nodes in a tree and pointers to its first and
+ * last nodes, so savl_tree_count(), savl_tree_first(), and savl_tree_last()
+ * are O(1).  A tree with a handle must be modified only by the
+ * <b>`savl_tree_`</b> functions, which keep the handle up to date, or by
+ * savl_link_at() and savl_multi_add() with an insertion point or entry that
+ * refers to the handle.  Functions that don't modify a tree (savl_get(),
+ * savl_next(), etc.) can be used with the handle's <b>`root`</b> member.
+ *
+ * @see	SAVL_TREE_INIT
+ */
+struct savl_tree {
+	struct savl_node	*root;	/**< Root node */
+	size_t			count;	/**< Number of nodes */
+	struct savl_node	*first;	/**< Node with the lowest key */
+	struct savl_node	*last;	/**< Node with the highest key */
+	_Bool			which_repl;	/**< Private */
+};
+
+/**
+ * Initializer for an empty {@link savl_tree}.
+ */
+#define SAVL_TREE_INIT	{ NULL, 0, NULL, NULL, 0 }
+
+/**
+ * Index-based tree node structure.
+ *
+ * Nodes of index-based trees are linked by 32-bit array indexes, rather than
+ * pointers, so each node is 12 bytes.  All of the elements of a tree must be
+ * stored in the same array, and each element must contain a node at the same
+ * offset.  (The node's parent index and skew are packed into a single field,
+ * so an array can contain at most <b>`SAVL_IDX_NONE`</b> elements.)
+ *
+ * @see	savl_idx_tree
+ */
+struct savl_idx_node {
+	uint32_t	parent_skew;
+	uint32_t	left;
+	uint32_t	right;
+};
+
+/**
+ * "Null" index value of index-based trees.
+ */
+#define SAVL_IDX_NONE	((uint32_t)0x3fffffff)
+
+/**
+ * Index-based tree.
+ *
+ * Unlike a pointer-based tree, which is represented by a pointer to its root
+ * node, an index-based tree is represented by this structure, which also
+ * describes the array that contains the tree's elements.  For example:
+ *
+ *	struct entry {
+ *		uint32_t		id;
+ *		struct savl_idx_node	avl;
+ *		uint64_t		value;
+ *	};
+ *
+ *	struct entry cache[CACHE_SIZE];
+ *
+ *	struct savl_idx_tree cache_tree =
+ *		SAVL_IDX_TREE_INIT(cache, struct entry, avl);
+ *
+ * @see	SAVL_IDX_TREE_INIT
+ * @see	savl_idx_cmpfn
+ */
+struct savl_idx_tree {
+	void		*base;		/**< Address of element 0 */
+	size_t		stride;		/**< Size of each element */
+	ptrdiff_t	offset;		/**< Offset of node within element */
+	uint32_t	root;		/**< Index of root element */
+};
+
+/**
+ * Initializer for an empty {@link savl_idx_tree}.
+ *
+ * @param base		The array that contains the tree's elements.
+ * @param type		The type of the array's elements.
+ * @param member	The name of the {@link savl_idx_node} member within
+ *			<b>`type`</b>.
+ */
+#define SAVL_IDX_TREE_INIT(base, type, member)				\
+	{ (base), sizeof(type), offsetof(type, member), SAVL_IDX_NONE }
+
+/**
+ * Index-based tree comparison function type.
+ *
+ * Identical to {@link savl_cmpfn}, except that it receives a pointer to the
+ * array element, rather than to the node within it.
+ *
+ * @param key	The key.
+ * @param elm	The array element.
+ *
+ * @return	Less than, equal to, or greater than zero, as the key is less
+ *		than, equal to, or greater than the element's key.
+ */
+typedef int (*savl_idx_cmpfn)(union savl_key key, const void *elm);
+
+/**
+ * Parent-free tree node structure.
+ *
+ * Nodes of parent-free trees have no parent pointer, so each node is 24 bytes
+ * (on 64-bit platforms) rather than 32.  Insertion and deletion record the
+ * path from the root on the stack, and iteration uses a
+ * {@link savl_pf_cursor}.  Parent-free trees can only be used with the
+ * <b>`savl_pf_`</b> functions.
+ *
+ * @see	savl_pf_cmpfn
+ */
+struct savl_pf_node {
+	struct savl_pf_node	*left;
+	struct savl_pf_node	*right;
+	int_fast8_t		skew;
+};
+
+/**
+ * Maximum depth of a tree.
+ *
+ * The depth of an AVL tree with n nodes is less than 1.45 log2(n + 2), so no
+ * tree that fits in a 64-bit address space can be deeper than this.
+ */
+#define SAVL_MAX_DEPTH	96
+
+/**
+ * Parent-free tree cursor.
+ *
+ * A cursor records the path from the root of a tree to its current node.
+ * Modifying the tree invalidates all of its cursors.  (A cursor is a
+ * {@link savl_iter} for parent-free nodes; the two types share their traversal
+ * code.)
+ *
+ * @see	savl_pf_first
+ */
+struct savl_pf_cursor {
+	struct savl_pf_node	*path[SAVL_MAX_DEPTH];
+	unsigned int		depth;
+};
+
+/**
+ * Tree iterator.
+ *
+ * An iterator records the path from the root of a tree to its current node,
+ * so stepping from one node to the next pops or pushes that path, rather than
+ * following parent pointers.  A full traversal touches each node once.
+ * Modifying the tree invalidates all of its iterators.
+ *
+ * @see	savl_iter_first
+ * @see	savl_iter_next_n
+ */
+struct savl_iter {
+	struct savl_node	*path[SAVL_MAX_DEPTH];
+	unsigned int		depth;
+};
+
+/**
+ * Parent-free tree comparison function type.
+ *
+ * Identical to {@link savl_cmpfn}, except for the type of the node.
+ */
+typedef int (*savl_pf_cmpfn)(union savl_key key,
+			     const struct savl_pf_node *node);
+
+/**
+ * Thread pool for parallel tree operations.
+ *
+ * @see	savl_pool_create
+ */
+struct savl_pool;
+
 /*
  * Functions are documented in avl.c
  */
 
+struct savl_node *savl_link(struct savl_node **const tree,
+			    struct savl_node *const parent, const int dir,
+			    struct savl_node *const new);
+
 struct savl_node *savl_add(struct savl_node **const tree,
 			   const savl_cmpfn cmpfn, const union savl_key key,
 			   struct savl_node *const new, const _Bool replace);
 
+struct savl_node *savl_add_hint(struct savl_node **const tree,
+				struct savl_node *const hint,
+				const savl_cmpfn cmpfn,
+				const union savl_key key,
+				struct savl_node *const new);
+
 struct savl_node *savl_try_add(struct savl_node **const tree,
 			       const savl_cmpfn cmpfn, const union savl_key key,
 			       struct savl_node *const new);
@@ -149,19 +695,520 @@ struct savl_node *savl_force_add(struct savl_node **const tree,
 				 const union savl_key key,
 				 struct savl_node *const new);
 
+struct savl_node *savl_locate(struct savl_node **const tree,
+			      const savl_cmpfn cmpfn, const union savl_key key,
+			      struct savl_point *const point);
+
+struct savl_node *savl_link_at(const struct savl_point *const point,
+			       struct savl_node *const new);
+
+struct savl_node *savl_multi_add(struct savl_multi_entry *const entries,
+				 const size_t count, size_t *const index);
+
+struct savl_node *savl_find_or_insert(struct savl_node **const tree,
+				      const savl_cmpfn cmpfn,
+				      const union savl_key key,
+				      const savl_ctorfn ctor, void *const ctx);
+
 struct savl_node *savl_remove(struct savl_node **const tree,
 			      const savl_cmpfn cmp, const union savl_key key);
 
 void savl_remove_node(struct savl_node *const node,
 		      struct savl_node **const tree);
 
+struct savl_node *savl_remove_node_next(struct savl_node *const node,
+					struct savl_node **const tree);
+
+struct savl_node *savl_remove_node_prev(struct savl_node *const node,
+					struct savl_node **const tree);
+
+struct savl_node *savl_rekey(struct savl_node *const node,
+			     struct savl_node **const tree,
+			     const savl_cmpfn cmpfn, const union savl_key key);
+
 struct savl_node *savl_get(struct savl_node *const tree, const savl_cmpfn cmpfn,
 			   const union savl_key key);
 
+struct savl_node *savl_lower_bound(struct savl_node *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key);
+
+struct savl_node *savl_upper_bound(struct savl_node *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key);
+
+struct savl_node *savl_floor(struct savl_node *const tree,
+			     const savl_cmpfn cmpfn, const union savl_key key);
+
+struct savl_node *savl_ceil(struct savl_node *const tree,
+			    const savl_cmpfn cmpfn, const union savl_key key);
+
+size_t savl_get_batch(struct savl_node *const tree, const savl_cmpfn cmpfn,
+		      const union savl_key *const keys, const size_t count,
+		      struct savl_node **const results);
+
+struct savl_node *savl_kadd(struct savl_node **const tree,
+			    const struct savl_keydesc *const desc,
+			    const union savl_key key,
+			    struct savl_node *const new, const _Bool replace);
+
+struct savl_node *savl_kremove(struct savl_node **const tree,
+			       const struct savl_keydesc *const desc,
+			       const union savl_key key);
+
+struct savl_node *savl_kget(struct savl_node *const tree,
+			    const struct savl_keydesc *const desc,
+			    const union savl_key key);
+
+struct savl_node *savl_join(struct savl_node *const left,
+			    struct savl_node *const pivot,
+			    struct savl_node *const right);
+
+struct savl_node *savl_split(struct savl_node **const tree,
+			     const savl_cmpfn cmpfn, const union savl_key key,
+			     struct savl_node **const left,
+			     struct savl_node **const right);
+
+void savl_union(struct savl_node **const tree, struct savl_node **const other,
+		const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		const savl_freefn freefn);
+
+void savl_intersection(struct savl_node **const tree,
+		       struct savl_node **const other,
+		       const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		       const savl_freefn freefn);
+
+void savl_difference(struct savl_node **const tree,
+		     struct savl_node **const other,
+		     const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		     const savl_freefn freefn);
+
+struct savl_node *savl_aug_link(struct savl_node **const tree,
+				struct savl_node *const parent, const int dir,
+				struct savl_node *const new,
+				const struct savl_aug *const aug);
+
+struct savl_node *savl_aug_add(struct savl_node **const tree,
+			       const savl_cmpfn cmpfn,
+			       const union savl_key key,
+			       struct savl_node *const new,
+			       const _Bool replace,
+			       const struct savl_aug *const aug);
+
+struct savl_node *savl_aug_remove(struct savl_node **const tree,
+				  const savl_cmpfn cmpfn,
+				  const union savl_key key,
+				  const struct savl_aug *const aug);
+
+void savl_aug_remove_node(struct savl_node *const node,
+			  struct savl_node **const tree,
+			  const struct savl_aug *const aug);
+
+void savl_aug_update(struct savl_node *const node,
+		     const struct savl_aug *const aug);
+
+struct savl_node *savl_sized_add(struct savl_node **const tree,
+				 const savl_cmpfn cmpfn,
+				 const union savl_key key,
+				 struct savl_node *const new,
+				 const _Bool replace);
+
+struct savl_node *savl_sized_remove(struct savl_node **const tree,
+				    const savl_cmpfn cmpfn,
+				    const union savl_key key);
+
+void savl_sized_remove_node(struct savl_node *const node,
+			    struct savl_node **const tree);
+
+struct savl_node *savl_select(struct savl_node *node, size_t index);
+size_t savl_rank(const struct savl_node *node);
+
+size_t savl_count_range(const struct savl_node *const tree,
+			const savl_cmpfn cmpfn,
+			const union savl_key lo, const union savl_key hi);
+
+void savl_interval_add(struct savl_node **const tree,
+		       struct savl_inode *const new);
+
+void savl_interval_remove(struct savl_inode *const node,
+			  struct savl_node **const tree);
+
+int savl_interval_overlap(struct savl_node *const tree,
+			  const uint64_t lo, const uint64_t hi,
+			  const savl_visitfn visitfn, void *const arg);
+
+int savl_interval_stab(struct savl_node *const tree, const uint64_t point,
+		       const savl_visitfn visitfn, void *const arg);
+
+_Bool savl_monoid_update(struct savl_node *const node, const void *const arg);
+
+void savl_reduce_range(struct savl_node *const tree, const savl_cmpfn cmpfn,
+		       const union savl_key lo, const union savl_key hi,
+		       const struct savl_monoid *const monoid,
+		       void *const result);
+
+uint32_t savl_idx_add(struct savl_idx_tree *const tree,
+		      const savl_idx_cmpfn cmpfn, const union savl_key key,
+		      const uint32_t index, const _Bool replace);
+
+uint32_t savl_idx_remove(struct savl_idx_tree *const tree,
+			 const savl_idx_cmpfn cmpfn, const union savl_key key);
+
+void savl_idx_remove_node(struct savl_idx_tree *const tree,
+			  const uint32_t index);
+
+uint32_t savl_idx_get(const struct savl_idx_tree *const tree,
+		      const savl_idx_cmpfn cmpfn, const union savl_key key);
+
+uint32_t savl_idx_first(const struct savl_idx_tree *const tree);
+uint32_t savl_idx_last(const struct savl_idx_tree *const tree);
+uint32_t savl_idx_next(const struct savl_idx_tree *const tree, uint32_t index);
+uint32_t savl_idx_prev(const struct savl_idx_tree *const tree, uint32_t index);
+
+struct savl_pf_node *savl_pf_add(struct savl_pf_node **const tree,
+				 const savl_pf_cmpfn cmpfn,
+				 const union savl_key key,
+				 struct savl_pf_node *const new,
+				 const _Bool replace);
+
+struct savl_pf_node *savl_pf_remove(struct savl_pf_node **const tree,
+				    const savl_pf_cmpfn cmpfn,
+				    const union savl_key key);
+
+struct savl_pf_node *savl_pf_get(struct savl_pf_node *node,
+				 const savl_pf_cmpfn cmpfn,
+				 const union savl_key key);
+
+struct savl_pf_node *savl_pf_first(struct savl_pf_cursor *const cursor,
+				   struct savl_pf_node *const tree);
+struct savl_pf_node *savl_pf_last(struct savl_pf_cursor *const cursor,
+				  struct savl_pf_node *const tree);
+struct savl_pf_node *savl_pf_next(struct savl_pf_cursor *const cursor);
+struct savl_pf_node *savl_pf_prev(struct savl_pf_cursor *const cursor);
+
+void savl_build_sorted(struct savl_node *const *const nodes, const size_t count,
+		       struct savl_node **const tree);
+
+struct savl_pool *savl_pool_create(unsigned int threads);
+void savl_pool_destroy(struct savl_pool *const pool);
+
+void savl_par_union(struct savl_pool *const pool,
+		    struct savl_node **const tree,
+		    struct savl_node **const other,
+		    const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		    const savl_freefn freefn);
+
+void savl_par_intersection(struct savl_pool *const pool,
+			   struct savl_node **const tree,
+			   struct savl_node **const other,
+			   const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+			   const savl_freefn freefn);
+
+void savl_par_difference(struct savl_pool *const pool,
+			 struct savl_node **const tree,
+			 struct savl_node **const other,
+			 const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+			 const savl_freefn freefn);
+
+void savl_par_add_bulk(struct savl_pool *const pool,
+		       struct savl_node **const tree,
+		       struct savl_node *const *const nodes, const size_t count,
+		       const savl_cmpfn cmpfn, const savl_keyfn keyfn,
+		       const savl_freefn freefn);
+
+void savl_par_remove_bulk(struct savl_pool *const pool,
+			  struct savl_node **const tree,
+			  const union savl_key *const keys, const size_t count,
+			  const savl_cmpfn cmpfn, const savl_freefn freefn);
+
+int savl_foreach_range(struct savl_node *const tree, const savl_cmpfn cmpfn,
+		       const union savl_key lo, const union savl_key hi,
+		       const savl_visitfn visitfn, void *const arg);
+
+struct savl_node *savl_remove_range(struct savl_node **const tree,
+				    const savl_cmpfn cmpfn,
+				    const union savl_key lo,
+				    const union savl_key hi,
+				    const savl_freefn freefn);
+
 void savl_free(struct savl_node **const tree, const savl_freefn freefn);
 struct savl_node *savl_next(struct savl_node *node);
 struct savl_node *savl_first(struct savl_node *node);
 struct savl_node *savl_last(struct savl_node *node);
 struct savl_node *savl_prev(struct savl_node *node);
 
+struct savl_node *savl_tree_link(struct savl_tree *const tree,
+				 struct savl_node *const parent, const int dir,
+				 struct savl_node *const new);
+
+struct savl_node *savl_tree_add(struct savl_tree *const tree,
+				const savl_cmpfn cmpfn,
+				const union savl_key key,
+				struct savl_node *const new,
+				const _Bool replace);
+
+struct savl_node *savl_tree_add_hint(struct savl_tree *const tree,
+				     struct savl_node *const hint,
+				     const savl_cmpfn cmpfn,
+				     const union savl_key key,
+				     struct savl_node *const new);
+
+struct savl_node *savl_tree_locate(struct savl_tree *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key,
+				   struct savl_point *const point);
+
+struct savl_node *savl_tree_find_or_insert(struct savl_tree *const tree,
+					   const savl_cmpfn cmpfn,
+					   const union savl_key key,
+					   const savl_ctorfn ctor,
+					   void *const ctx);
+
+void savl_tree_remove_node(struct savl_tree *const tree,
+			   struct savl_node *const node);
+
+struct savl_node *savl_tree_remove_node_next(struct savl_tree *const tree,
+					     struct savl_node *const node);
+struct savl_node *savl_tree_remove_node_prev(struct savl_tree *const tree,
+					     struct savl_node *const node);
+
+struct savl_node *savl_tree_rekey(struct savl_tree *const tree,
+				  struct savl_node *const node,
+				  const savl_cmpfn cmpfn,
+				  const union savl_key key);
+
+struct savl_node *savl_tree_remove(struct savl_tree *const tree,
+				   const savl_cmpfn cmpfn,
+				   const union savl_key key);
+
+struct savl_node *savl_tree_pop_first(struct savl_tree *const tree);
+struct savl_node *savl_tree_pop_last(struct savl_tree *const tree);
+void savl_tree_free(struct savl_tree *const tree, const savl_freefn freefn);
+
+struct savl_node *savl_iter_first(struct savl_iter *const it,
+				  struct savl_node *const tree);
+struct savl_node *savl_iter_last(struct savl_iter *const it,
+				 struct savl_node *const tree);
+struct savl_node *savl_iter_seek(struct savl_iter *const it,
+				 struct savl_node *const tree,
+				 const savl_cmpfn cmpfn,
+				 const union savl_key key);
+struct savl_node *savl_iter_next(struct savl_iter *const it);
+struct savl_node *savl_iter_prev(struct savl_iter *const it);
+size_t savl_iter_next_n(struct savl_iter *const it,
+			struct savl_node **const out, const size_t count);
+
+/**
+ * Get the number of nodes in a tree with a handle.
+ *
+ * @param tree	The tree.
+ *
+ * @return	The number of nodes in the tree.
+ */
+static inline size_t savl_tree_count(const struct savl_tree *const tree)
+{
+	return tree->count;
+}
+
+/**
+ * Get the first (lowest key) node in a tree with a handle.
+ *
+ * @param tree	The tree.
+ *
+ * @return	The first node (or <b>`NULL`</b> if the tree is empty).
+ */
+static inline struct savl_node *savl_tree_first(const struct savl_tree *tree)
+{
+	return tree->first;
+}
+
+/**
+ * Get the last (highest key) node in a tree with a handle.
+ *
+ * @param tree	The tree.
+ *
+ * @return	The last node (or <b>`NULL`</b> if the tree is empty).
+ */
+static inline struct savl_node *savl_tree_last(const struct savl_tree *tree)
+{
+	return tree->last;
+}
+
+/**
+ * Generates type-safe, inline functions that operate on trees of a particular
+ * type of data structure, using a particular comparison function.
+ *
+ * Functions such as savl_get() and savl_add() must make an indirect call
+ * through their comparison callback function at every level of the tree.
+ * Because the comparison function for a tree of a particular type is known at
+ * compile time, the functions generated by this macro are able to use a
+ * comparison function that can be inlined into the search loop.
+ *
+ * The comparison function must have the following signature, and it must return
+ * a value that is less than zero, zero, or greater than zero, depending on
+ * whether <b>`key`</b> is less than, equal to, or greater than the key of
+ * <b>`elm`</b>.  (It should normally be declared <b>`static inline`</b>.)
+ *
+ *	int cmp(const keytype key, const type *elm);
+ *
+ * The following functions are generated (<b>`name_`</b> is replaced by the
+ * value of the <b>`name`</b> parameter).
+ *
+ *	type *name_get(struct savl_node *tree, const keytype key);
+ *	type *name_add(struct savl_node **tree, const keytype key,
+ *		       type *elm, _Bool replace);
+ *	type *name_try_add(struct savl_node **tree, const keytype key,
+ *			   type *elm);
+ *	type *name_force_add(struct savl_node **tree, const keytype key,
+ *			     type *elm);
+ *	type *name_remove(struct savl_node **tree, const keytype key);
+ *	type *name_first(struct savl_node *tree);
+ *	type *name_last(struct savl_node *tree);
+ *	type *name_next(type *elm);
+ *	type *name_prev(type *elm);
+ *
+ * They behave in the same way as the corresponding library functions, except
+ * that they accept and return pointers to the containing data structures,
+ * rather than pointers to the embedded {@link savl_node} structures.  For
+ * example:
+ *
+ *	struct product {
+ *		unsigned int		sku;
+ *		unsigned int		price;
+ *		struct savl_node	avl;
+ *		char			*description;
+ *	};
+ *
+ *	static inline int compare_skus(const unsigned int sku,
+ *				       const struct product *prod)
+ *	{
+ *		return (sku > prod->sku) - (sku < prod->sku);
+ *	}
+ *
+ *	SAVL_GENERATE(prod, struct product, avl, unsigned int, compare_skus)
+ *
+ *	struct product *get_product(struct savl_node *tree, unsigned int sku)
+ *	{
+ *		return prod_get(tree, sku);
+ *	}
+ *
+ * @param name		Prefix of the names of the generated functions.
+ * @param type		The type of the containing structure.
+ * @param member	The name of the {@link savl_node} member within the
+ *			containing structure.
+ * @param keytype	The type of the keys passed to the generated functions
+ *			(and to the comparison function).
+ * @param cmp		The comparison function.
+ *
+ * @see	SAVL_NODE_CONTAINER
+ */
+#define SAVL_GENERATE(name, type, member, keytype, cmp)			\
+									\
+static inline type *name##_elm(struct savl_node *const node)		\
+{									\
+	if (node == NULL)						\
+		return NULL;						\
+									\
+	return SAVL_NODE_CONTAINER(node, type, member);			\
+}									\
+									\
+static inline int name##_search(struct savl_node *node,			\
+				const keytype key,			\
+				struct savl_node **const result)	\
+{									\
+	int cmp_result = 0;						\
+									\
+	while (node != NULL) {						\
+									\
+		cmp_result = cmp(key, name##_elm(node));		\
+									\
+		if (cmp_result < 0 && node->left != NULL) {		\
+			node = node->left;				\
+			continue;					\
+		}							\
+									\
+		if (cmp_result > 0 && node->right != NULL) {		\
+			node = node->right;				\
+			continue;					\
+		}							\
+									\
+		break;							\
+	}								\
+									\
+	*result = node;							\
+									\
+	return (cmp_result > 0) - (cmp_result < 0);			\
+}									\
+									\
+static inline type *name##_get(struct savl_node *const tree,		\
+			       const keytype key)			\
+{									\
+	struct savl_node *node;						\
+									\
+	if (name##_search(tree, key, &node) == 0)			\
+		return name##_elm(node);				\
+									\
+	return NULL;							\
+}									\
+									\
+static inline type *name##_add(struct savl_node **const tree,		\
+			       const keytype key, type *const elm,	\
+			       const _Bool replace)			\
+{									\
+	struct savl_node *parent;					\
+	int dir;							\
+									\
+	dir = name##_search(*tree, key, &parent);			\
+									\
+	if (dir == 0 && parent != NULL && !replace)			\
+		return name##_elm(parent);				\
+									\
+	return name##_elm(savl_link(tree, parent, dir, &elm->member));	\
+}									\
+									\
+static inline type *name##_try_add(struct savl_node **const tree,	\
+				   const keytype key, type *const elm)	\
+{									\
+	return name##_add(tree, key, elm, 0);				\
+}									\
+									\
+static inline type *name##_force_add(struct savl_node **const tree,	\
+				     const keytype key, type *const elm) \
+{									\
+	return name##_add(tree, key, elm, 1);				\
+}									\
+									\
+static inline type *name##_remove(struct savl_node **const tree,	\
+				  const keytype key)			\
+{									\
+	struct savl_node *node;						\
+									\
+	if (name##_search(*tree, key, &node) != 0 || node == NULL)	\
+		return NULL;						\
+									\
+	savl_remove_node(node, tree);					\
+									\
+	return name##_elm(node);					\
+}									\
+									\
+static inline type *name##_first(struct savl_node *const tree)		\
+{									\
+	return name##_elm(savl_first(tree));				\
+}									\
+									\
+static inline type *name##_last(struct savl_node *const tree)		\
+{									\
+	return name##_elm(savl_last(tree));				\
+}									\
+									\
+static inline type *name##_next(type *const elm)			\
+{									\
+	return name##_elm(savl_next(&elm->member));			\
+}									\
+									\
+static inline type *name##_prev(type *const elm)			\
+{									\
+	return name##_elm(savl_prev(&elm->member));			\
+}
+
 #endif	/* SAVL_H_INCLUDED */